@@ -0,0 +1,482 @@
+/**
+ * 委托的性能测试，测量调用（包括成员函数）、添加与移除（包括批量操作）、复制和比较的耗时，并与std::function和函数指针进行对比。
+ * 结果以JSON格式输出，可通过以下参数控制：
+ *   --filter=<str>     只运行名称包含str的测试
+ *   --min-time=<sec>   每项测试的最短运行时间，默认为0.2秒
+ *   --out=<file>       将结果写入文件而不是标准输出
+ */
+
+#include "delegate.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+namespace
+{
+    /**
+     * @brief 被调用的函数写入该变量，防止调用被优化掉
+     */
+    volatile int g_sink = 0;
+
+    BENCH_NOINLINE void Handler(int x)
+    {
+        g_sink = g_sink + x;
+    }
+
+    BENCH_NOINLINE void OtherHandler(int x)
+    {
+        g_sink = g_sink - x;
+    }
+
+    BENCH_NOINLINE int Transform(int x)
+    {
+        return x + g_sink;
+    }
+
+    struct Receiver {
+        int value = 0;
+
+        void OnEvent(int x)
+        {
+            value += x;
+        }
+    };
+
+    /**
+     * @brief 防止编译器将value视为未使用而优化掉
+     */
+    template <typename T>
+    inline void DoNotOptimize(const T &value)
+    {
+#if defined(_MSC_VER)
+        static volatile const void *sink;
+        sink = &value;
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+
+    /**
+     * @brief 单项测试的结果
+     */
+    struct Result {
+        std::string name;
+        size_t handlers;
+        uint64_t iterations;
+        double nsPerOp;
+    };
+
+    /**
+     * @brief 测试运行器，自动调整迭代次数使每项测试至少运行指定的时间
+     */
+    class Runner
+    {
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr uint64_t MAX_ITERATIONS = uint64_t(1) << 32;
+
+        std::string _filter;
+        double _minTime;
+        std::vector<Result> _results;
+
+    public:
+        Runner(const std::string &filter, double minTime)
+            : _filter(filter), _minTime(minTime)
+        {
+        }
+
+        /**
+         * @brief          运行一项测试
+         * @param name     测试名称，结果中的名称为name/handlers
+         * @param handlers 测试使用的可调用对象数量
+         * @param body     形如void(uint64_t iterations)的函数，执行指定次数的操作
+         */
+        template <typename F>
+        void Run(const std::string &name, size_t handlers, F &&body)
+        {
+            std::string fullName = name + "/" + std::to_string(handlers);
+            if (!_filter.empty() && fullName.find(_filter) == std::string::npos) {
+                return;
+            }
+
+            uint64_t iterations = 1;
+            for (;;) {
+                auto start = Clock::now();
+                body(iterations);
+                double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+                if (elapsed >= _minTime || iterations >= MAX_ITERATIONS) {
+                    _results.push_back({fullName, handlers, iterations, elapsed * 1e9 / iterations});
+                    std::fprintf(stderr, "%-40s %12.2f ns/op\n", fullName.c_str(), _results.back().nsPerOp);
+                    return;
+                }
+                double scale = elapsed > 0 ? _minTime * 1.2 / elapsed : 100.0;
+                iterations   = static_cast<uint64_t>(iterations * std::min(std::max(scale, 2.0), 100.0));
+                if (iterations > MAX_ITERATIONS) iterations = MAX_ITERATIONS;
+            }
+        }
+
+        /**
+         * @brief 以JSON格式输出所有结果
+         */
+        void Print(FILE *file) const
+        {
+            std::fprintf(file, "{\n");
+            std::fprintf(file, "  \"context\": {\n");
+#if defined(DELEGATE_DISABLE_SAFEINVOKE)
+            std::fprintf(file, "    \"safe_invoke\": false,\n");
+#else
+            std::fprintf(file, "    \"safe_invoke\": true,\n");
+#endif
+            std::fprintf(file, "    \"inline_size\": %u,\n", static_cast<unsigned>(DELEGATE_INLINE_SIZE));
+#if defined(__clang__)
+            std::fprintf(file, "    \"compiler\": \"clang %s\",\n", __clang_version__);
+#elif defined(__GNUC__)
+            std::fprintf(file, "    \"compiler\": \"gcc %s\",\n", __VERSION__);
+#elif defined(_MSC_VER)
+            std::fprintf(file, "    \"compiler\": \"MSVC %d\",\n", _MSC_VER);
+#endif
+            std::fprintf(file, "    \"cplusplus\": %ld,\n", static_cast<long>(__cplusplus));
+            std::fprintf(file, "    \"min_time\": %g\n", _minTime);
+            std::fprintf(file, "  },\n");
+            std::fprintf(file, "  \"benchmarks\": [");
+            for (size_t i = 0; i < _results.size(); ++i) {
+                const Result &result = _results[i];
+                std::fprintf(file, "%s\n    {\"name\": \"%s\", \"handlers\": %u, \"iterations\": %llu, \"ns_per_op\": %.3f}",
+                             i == 0 ? "" : ",", result.name.c_str(), static_cast<unsigned>(result.handlers),
+                             static_cast<unsigned long long>(result.iterations), result.nsPerOp);
+            }
+            std::fprintf(file, "\n  ]\n}\n");
+        }
+    };
+
+    const size_t HANDLER_COUNTS[] = {0, 1, 2, 8, 64};
+
+    Action<int> MakeDelegate(size_t count)
+    {
+        Action<int> delegate;
+        for (size_t i = 0; i < count; ++i) {
+            delegate += Handler;
+        }
+        return delegate;
+    }
+
+    /**
+     * @brief 调用：委托与std::function数组、函数指针数组逐个调用的对比
+     */
+    void BenchDispatch(Runner &runner)
+    {
+        for (size_t count : HANDLER_COUNTS) {
+            Action<int> delegate = MakeDelegate(count);
+            runner.Run("dispatch/delegate", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    DoNotOptimize(delegate); // 阻止将空委托的判断提到循环外
+                    if (delegate != nullptr) delegate(static_cast<int>(i));
+                }
+            });
+
+            // 由两个各包含一半对象的委托组成：作为嵌套的委托添加与通过Combine合并的对比
+            if (count >= 2) {
+                Action<int> left  = MakeDelegate(count / 2);
+                Action<int> right = MakeDelegate(count - count / 2);
+                Action<int> nested;
+                nested += left;
+                nested += right;
+                runner.Run("dispatch/delegate_nested", count, [&](uint64_t iterations) {
+                    for (uint64_t i = 0; i < iterations; ++i) nested(static_cast<int>(i));
+                });
+
+                Action<int> combined = left + right;
+                runner.Run("dispatch/delegate_combined", count, [&](uint64_t iterations) {
+                    for (uint64_t i = 0; i < iterations; ++i) combined(static_cast<int>(i));
+                });
+            }
+
+            std::vector<std::function<void(int)>> functions(count, Handler);
+            runner.Run("dispatch/std_function", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    for (auto &function : functions) function(static_cast<int>(i));
+                }
+            });
+
+            std::vector<void (*)(int)> pointers(count, Handler);
+            DoNotOptimize(pointers.data());
+            runner.Run("dispatch/function_pointer", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    for (auto pointer : pointers) pointer(static_cast<int>(i));
+                }
+            });
+        }
+    }
+
+    /**
+     * @brief 调用成员函数：运行时的成员函数指针与编译期绑定的成员函数的对比
+     */
+    void BenchDispatchMember(Runner &runner)
+    {
+        for (size_t count : HANDLER_COUNTS) {
+            if (count == 0) continue;
+            Receiver receiver;
+
+            Action<int> member;
+            for (size_t i = 0; i < count; ++i) {
+                member.Add(receiver, &Receiver::OnEvent);
+            }
+            runner.Run("dispatch_member/delegate", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) member(static_cast<int>(i));
+            });
+
+            Action<int> bound;
+            for (size_t i = 0; i < count; ++i) {
+                bound.Add<Receiver, &Receiver::OnEvent>(receiver);
+            }
+            runner.Run("dispatch_member/delegate_bound", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) bound(static_cast<int>(i));
+            });
+
+            std::vector<std::function<void(int)>> functions(count, [&receiver](int x) { receiver.OnEvent(x); });
+            runner.Run("dispatch_member/std_function", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    for (auto &function : functions) function(static_cast<int>(i));
+                }
+            });
+            DoNotOptimize(receiver.value);
+        }
+    }
+
+    /**
+     * @brief 收集返回值：InvokeAll与逐个调用std::function并保存结果的对比
+     */
+    void BenchInvokeAll(Runner &runner)
+    {
+        for (size_t count : HANDLER_COUNTS) {
+            Func<int, int> delegate;
+            for (size_t i = 0; i < count; ++i) {
+                delegate += Transform;
+            }
+            runner.Run("invoke_all/delegate", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    DoNotOptimize(delegate); // 阻止将空委托的判断提到循环外
+                    if (delegate == nullptr) continue;
+                    auto results = delegate.InvokeAll(static_cast<int>(i));
+                    DoNotOptimize(results.data());
+                }
+            });
+
+            std::vector<std::function<int(int)>> functions(count, Transform);
+            runner.Run("invoke_all/std_function", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    std::vector<int> results;
+                    results.reserve(functions.size());
+                    for (auto &function : functions) results.push_back(function(static_cast<int>(i)));
+                    DoNotOptimize(results.data());
+                }
+            });
+        }
+    }
+
+    /**
+     * @brief 添加与移除：在已有count个对象的基础上反复添加并移除一个对象
+     */
+    void BenchChurn(Runner &runner)
+    {
+        for (size_t count : HANDLER_COUNTS) {
+            Action<int> delegate = MakeDelegate(count);
+            runner.Run("churn/delegate", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    delegate += OtherHandler;
+                    delegate -= OtherHandler;
+                }
+            });
+
+            runner.Run("churn/delegate_token", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    SubscriptionToken token = delegate.Subscribe(OtherHandler);
+                    delegate.Unsubscribe(token);
+                }
+            });
+
+            // std::function无法比较，只能按位置移除
+            std::vector<std::function<void(int)>> functions(count, Handler);
+            runner.Run("churn/std_function", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    functions.push_back(OtherHandler);
+                    functions.pop_back();
+                }
+            });
+
+            std::vector<void (*)(int)> pointers(count, Handler);
+            runner.Run("churn/function_pointer", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    pointers.push_back(OtherHandler);
+                    pointers.erase(std::find(pointers.rbegin(), pointers.rend(), &OtherHandler).base() - 1);
+                    DoNotOptimize(pointers.data());
+                }
+            });
+        }
+    }
+
+    /**
+     * @brief 批量添加与移除：从空委托开始添加count个对象，以及添加后再全部移除（包含添加的耗时）
+     */
+    void BenchBulk(Runner &runner)
+    {
+        for (size_t count : HANDLER_COUNTS) {
+            if (count == 0) continue;
+            std::vector<void (*)(int)> pointers(count, Handler);
+            runner.Run("bulk/delegate_add", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    Action<int> delegate;
+                    for (auto pointer : pointers) delegate += pointer;
+                    DoNotOptimize(delegate);
+                }
+            });
+
+            runner.Run("bulk/delegate_add_range", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    Action<int> delegate;
+                    delegate.AddRange(pointers);
+                    DoNotOptimize(delegate);
+                }
+            });
+
+            std::vector<Receiver> receivers(count);
+            runner.Run("bulk/delegate_remove", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    Action<int> delegate;
+                    for (auto &receiver : receivers) delegate.Add(receiver, &Receiver::OnEvent);
+                    for (auto &receiver : receivers) delegate.Remove(receiver, &Receiver::OnEvent);
+                    DoNotOptimize(delegate);
+                }
+            });
+
+            runner.Run("bulk/delegate_remove_if", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    Action<int> delegate;
+                    delegate.Reserve(count);
+                    for (auto &receiver : receivers) delegate.Add(receiver, &Receiver::OnEvent);
+                    delegate.RemoveIf([](const ICallable<void(int)> &) { return true; });
+                    DoNotOptimize(delegate);
+                }
+            });
+
+            runner.Run("bulk/std_function", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    std::vector<std::function<void(int)>> functions;
+                    for (auto pointer : pointers) functions.push_back(pointer);
+                    DoNotOptimize(functions.data());
+                }
+            });
+        }
+    }
+
+    /**
+     * @brief 复制构造
+     */
+    void BenchCopy(Runner &runner)
+    {
+        for (size_t count : HANDLER_COUNTS) {
+            Action<int> delegate = MakeDelegate(count);
+            runner.Run("copy/delegate", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    Action<int> copy(delegate);
+                    DoNotOptimize(copy);
+                }
+            });
+
+            std::vector<std::function<void(int)>> functions(count, Handler);
+            runner.Run("copy/std_function", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    std::vector<std::function<void(int)>> copy(functions);
+                    DoNotOptimize(copy.data());
+                }
+            });
+
+            std::vector<void (*)(int)> pointers(count, Handler);
+            runner.Run("copy/function_pointer", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    std::vector<void (*)(int)> copy(pointers);
+                    DoNotOptimize(copy.data());
+                }
+            });
+        }
+    }
+
+    /**
+     * @brief 比较：两个分别构造、内容相同的委托（不共享存储）
+     */
+    void BenchEquals(Runner &runner)
+    {
+        for (size_t count : HANDLER_COUNTS) {
+            Action<int> left  = MakeDelegate(count);
+            Action<int> right = MakeDelegate(count);
+            runner.Run("equals/delegate", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    bool equal = left == right;
+                    DoNotOptimize(equal);
+                }
+            });
+
+            std::vector<void (*)(int)> leftPointers(count, Handler);
+            std::vector<void (*)(int)> rightPointers(count, Handler);
+            runner.Run("equals/function_pointer", count, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    bool equal = leftPointers == rightPointers;
+                    DoNotOptimize(equal);
+                }
+            });
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string filter;
+    double minTime  = 0.2;
+    const char *out = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+            filter = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--min-time=", 11) == 0) {
+            minTime = std::atof(argv[i] + 11);
+        } else if (std::strncmp(argv[i], "--out=", 6) == 0) {
+            out = argv[i] + 6;
+        } else {
+            std::fprintf(stderr, "usage: %s [--filter=<str>] [--min-time=<sec>] [--out=<file>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Runner runner(filter, minTime);
+    BenchDispatch(runner);
+    BenchDispatchMember(runner);
+    BenchInvokeAll(runner);
+    BenchChurn(runner);
+    BenchBulk(runner);
+    BenchCopy(runner);
+    BenchEquals(runner);
+
+    FILE *file = out == nullptr ? stdout : std::fopen(out, "w");
+    if (file == nullptr) {
+        std::fprintf(stderr, "cannot open %s\n", out);
+        return 1;
+    }
+    runner.Print(file);
+    if (file != stdout) {
+        std::fclose(file);
+    }
+    return 0;
+}
@@ -3,24 +3,177 @@
 
 // #define DELEGATE_DISABLE_SAFEINVOKE
 
+// 可调用对象的内联存储大小，不超过该大小的可调用对象在委托只包含单个可调用对象时不会产生堆分配
+#ifndef DELEGATE_INLINE_SIZE
+#define DELEGATE_INLINE_SIZE (4 * sizeof(void *))
+#endif
+
+// ConcurrentDelegate中读者计数器的数量，不同线程的调用分散到不同计数器上以减少竞争
+#ifndef DELEGATE_CONCURRENT_STRIPES
+#define DELEGATE_CONCURRENT_STRIPES 8
+#endif
+
+// 编译器支持时，Delegate和CallableList可以指定std::pmr::memory_resource分配内存
+#if !defined(DELEGATE_HAS_MEMORY_RESOURCE) && defined(__has_include)
+#if __has_include(<memory_resource>) && (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#define DELEGATE_HAS_MEMORY_RESOURCE
+#endif
+#endif
+
+// 编译器支持C++20协程时，Delegate提供可以co_await的异步调用
+#if !defined(DELEGATE_HAS_COROUTINE) && defined(__has_include)
+#if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#define DELEGATE_HAS_COROUTINE
+#endif
+#endif
+
+// 编译器支持C++17的auto非类型模板参数时，Delegate可以通过Add<&T::Method>(obj)在编译期绑定成员函数
+#if !defined(DELEGATE_HAS_AUTO_TEMPLATE_PARAMETER) && defined(__cpp_nontype_template_parameter_auto)
+#define DELEGATE_HAS_AUTO_TEMPLATE_PARAMETER
+#endif
+
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <exception>
+#include <functional>
+#include <future>
+#include <initializer_list>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#if defined(DELEGATE_HAS_COROUTINE)
+#include <coroutine>
+#endif
+#if defined(DELEGATE_HAS_MEMORY_RESOURCE)
+#include <memory_resource>
+#endif
 #include <stdexcept>
 #include <tuple>
 #include <type_traits>
-#include <typeindex>
 #include <vector>
 
 // ICallable接口声明
 template <typename>
 struct ICallable;
 
+// CallableList类声明
+template <typename>
+class CallableList;
+
 // Delegate类声明
 template <typename>
 class Delegate;
 
+// ConcurrentDelegate类声明
+template <typename>
+class ConcurrentDelegate;
+
+// StaticDelegate类声明
+template <typename, size_t>
+class StaticDelegate;
+
+// DeferredDelegate类声明
+template <typename>
+class DeferredDelegate;
+
+/*================================================================================*/
+
+/**
+ * @brief 编译期整数序列，用于展开元组
+ */
+template <size_t... Indices>
+struct _IndexSequence {
+};
+
+/**
+ * @brief 生成0到N-1的整数序列
+ */
+template <size_t N, size_t... Indices>
+struct _MakeIndexSequence : _MakeIndexSequence<N - 1, N - 1, Indices...> {
+};
+
+/**
+ * @brief _MakeIndexSequence特化
+ */
+template <size_t... Indices>
+struct _MakeIndexSequence<0, Indices...> {
+    using type = _IndexSequence<Indices...>;
+};
+
+/*================================================================================*/
+
+/**
+ * @brief 类型标识，以每个类型独有的静态变量的地址表示类型，比较时只需比较指针，且不依赖RTTI
+ */
+class TypeId
+{
+    /**
+     * @brief 每个类型独有的静态变量
+     */
+    template <typename T>
+    struct _Tag {
+        static const char value;
+    };
+
+    /**
+     * @brief 类型对应的静态变量的地址
+     */
+    const void *_value;
+
+    explicit TypeId(const void *value) noexcept
+        : _value(value)
+    {
+    }
+
+public:
+    /**
+     * @brief 获取指定类型的类型标识
+     */
+    template <typename T>
+    static TypeId Of() noexcept
+    {
+        return TypeId(&_Tag<T>::value);
+    }
+
+    /**
+     * @brief 获取类型标识的哈希值
+     */
+    size_t hash_code() const noexcept
+    {
+        return reinterpret_cast<size_t>(_value);
+    }
+
+    /**
+     * @brief 判断两个类型标识是否相等
+     */
+    bool operator==(const TypeId &other) const noexcept
+    {
+        return _value == other._value;
+    }
+
+    /**
+     * @brief 判断两个类型标识是否不相等
+     */
+    bool operator!=(const TypeId &other) const noexcept
+    {
+        return _value != other._value;
+    }
+
+    /**
+     * @brief 比较两个类型标识，用于有序容器
+     */
+    bool operator<(const TypeId &other) const noexcept
+    {
+        return std::less<const void *>()(_value, other._value);
+    }
+};
+
+template <typename T>
+const char TypeId::_Tag<T>::value = 0;
+
 /*================================================================================*/
 
 /**
@@ -48,7 +201,7 @@ struct ICallable<TRet(Args...)> {
     /**
      * @brief 获取当前可调用对象的类型信息
      */
-    virtual std::type_index GetType() const = 0;
+    virtual TypeId GetType() const = 0;
 
     /**
      * @brief       判断当前可调用对象是否与另一个可调用对象相等
@@ -56,1020 +209,6387 @@ struct ICallable<TRet(Args...)> {
      * @return      如果相等则返回true，否则返回false
      */
     virtual bool Equals(const ICallable &other) const = 0;
+
+    /**
+     * @brief 获取当前可调用对象的哈希值，用于在建立了索引的委托中快速查找
+     * @note  相等的可调用对象必须返回相同的哈希值，默认实现只使用类型信息
+     */
+    virtual size_t GetHashCode() const noexcept
+    {
+        return GetType().hash_code();
+    }
 };
 
 /*================================================================================*/
 
 /**
- * @brief 用于存储和管理多个可调用对象的列表，针对单个可调用对象的情况进行优化
+ * @brief 订阅令牌，由Delegate::Subscribe返回，可用于以O(1)的代价移除对应的可调用对象
+ * @note  令牌在获取令牌之前复制出的副本中同样有效，对应的可调用对象被移除后令牌失效；
+ *        每个令牌的序号全局唯一，副本各自获取的令牌不会互相混淆，也不会被其他委托接受
  */
-template <typename T>
-class CallableList
+class SubscriptionToken
 {
+    /**
+     * @brief 令牌的值，低32位为句柄索引，高32位为句柄序号，为0时表示空令牌
+     */
+    uint64_t _value;
+
 public:
     /**
-     * @brief 可调用对象类型别名
+     * @brief 默认构造函数，构造一个空令牌
+     */
+    SubscriptionToken() noexcept
+        : _value(0)
+    {
+    }
+
+    /**
+     * @brief 构造函数，接受令牌的值
      */
-    using TCallable = ICallable<T>;
+    explicit SubscriptionToken(uint64_t value) noexcept
+        : _value(value)
+    {
+    }
 
     /**
-     * @brief 智能指针类型别名，用于存储可调用对象的唯一指针
+     * @brief 获取令牌的值
      */
-    using TSinglePtr = std::unique_ptr<TCallable>;
+    uint64_t Value() const noexcept
+    {
+        return _value;
+    }
 
     /**
-     * @brief 列表类型别名，用于存储多个可调用对象的智能指针
+     * @brief  判断令牌是否非空
+     * @return 如果令牌不为空则返回true，否则返回false
      */
-    using TSharedList = std::vector<std::shared_ptr<TCallable>>;
+    explicit operator bool() const noexcept
+    {
+        return _value != 0;
+    }
 
-private:
     /**
-     * @brief 内部存储可调用对象的联合体
+     * @brief 判断两个令牌是否相等
      */
-    mutable union {
-        alignas(TSinglePtr) uint8_t _single[sizeof(TSinglePtr)];
-        alignas(TSharedList) uint8_t _list[sizeof(TSharedList)];
-    } _data = {};
+    bool operator==(const SubscriptionToken &other) const noexcept
+    {
+        return _value == other._value;
+    }
 
     /**
-     * @brief 当前状态枚举
+     * @brief 判断两个令牌是否不相等
      */
-    enum : uint8_t {
-        STATE_NONE,   // 未存储任何可调用对象
-        STATE_SINGLE, // 储存了一个可调用对象
-        STATE_LIST,   // 储存了多个可调用对象
-    } _state = STATE_NONE;
+    bool operator!=(const SubscriptionToken &other) const noexcept
+    {
+        return _value != other._value;
+    }
+};
+
+/*================================================================================*/
+
+/**
+ * @brief 取消标志，配合InvokeUntil使用，设置后尚未被调用的可调用对象将被跳过
+ * @note  可以由正在被调用的对象或其他线程设置
+ */
+class CancellationFlag
+{
+    std::atomic<bool> _cancelled;
 
 public:
     /**
-     * @brief 默认构造函数
+     * @brief 默认构造函数，创建一个未取消的标志
      */
-    CallableList()
+    CancellationFlag() noexcept
+        : _cancelled(false)
     {
     }
 
+    CancellationFlag(const CancellationFlag &)            = delete;
+    CancellationFlag &operator=(const CancellationFlag &) = delete;
+
     /**
-     * @brief 拷贝构造函数
+     * @brief 设置取消标志
      */
-    CallableList(const CallableList &other)
+    void Cancel() noexcept
     {
-        *this = other;
+        _cancelled.store(true, std::memory_order_relaxed);
     }
 
     /**
-     * @brief 移动构造函数
+     * @brief 清除取消标志，以便再次使用
      */
-    CallableList(CallableList &&other) noexcept
+    void Reset() noexcept
     {
-        *this = std::move(other);
+        _cancelled.store(false, std::memory_order_relaxed);
     }
 
     /**
-     * @brief 拷贝赋值运算
+     * @brief  判断是否已设置取消标志
+     * @return 如果已取消则返回true，否则返回false
      */
-    CallableList &operator=(const CallableList &other)
+    bool IsCancelled() const noexcept
     {
-        if (this == &other) {
-            return *this;
-        }
+        return _cancelled.load(std::memory_order_relaxed);
+    }
+};
 
-        _Reset(other._state);
+/*================================================================================*/
 
-        switch (other._state) {
-            case STATE_NONE: {
-                break;
-            }
-            case STATE_SINGLE: {
-                _GetSingle().reset(other._GetSingle()->Clone());
-                break;
-            }
-            case STATE_LIST: {
-                _GetList() = other._GetList();
-                break;
-            }
+/**
+ * @brief 可被弱订阅跟踪的对象基类，派生类对象析构后，通过Delegate::AddWeak添加的成员函数将不再被调用
+ * @note  弱订阅通过共享的控制块判断对象是否存活，控制块在对象首次被弱订阅时分配，调用时只需一次原子读取。
+ *        派生类析构函数执行期间对象仍被视为存活；对象的析构不应与对其弱订阅的调用在不同线程上同时进行
+ */
+class Trackable
+{
+    /**
+     * @brief 控制块，由对象本身和各个WeakHandle共同持有
+     */
+    struct _Control {
+        std::atomic<Trackable *> owner; // 被跟踪的对象，对象析构后为nullptr
+        std::atomic<size_t> refs;
+
+        explicit _Control(Trackable *owner) noexcept
+            : owner(owner), refs(1)
+        {
         }
-        return *this;
-    }
+    };
 
     /**
-     * @brief 移动赋值运算
+     * @brief 控制块，尚未被弱订阅时为nullptr
      */
-    CallableList &operator=(CallableList &&other) noexcept
+    mutable std::atomic<_Control *> _control;
+
+public:
+    /**
+     * @brief 指向Trackable对象的弱句柄，不延长对象的生命周期
+     */
+    class WeakHandle
     {
-        if (this == &other) {
+        friend class Trackable;
+
+        _Control *_control;
+
+        explicit WeakHandle(_Control *control) noexcept
+            : _control(control)
+        {
+            if (_control != nullptr) {
+                _control->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+    public:
+        /**
+         * @brief 默认构造函数，创建一个空句柄
+         */
+        WeakHandle() noexcept
+            : _control(nullptr)
+        {
+        }
+
+        WeakHandle(const WeakHandle &other) noexcept
+            : WeakHandle(other._control)
+        {
+        }
+
+        WeakHandle(WeakHandle &&other) noexcept
+            : _control(other._control)
+        {
+            other._control = nullptr;
+        }
+
+        WeakHandle &operator=(WeakHandle other) noexcept
+        {
+            std::swap(_control, other._control);
             return *this;
         }
 
-        _Reset(other._state);
+        ~WeakHandle()
+        {
+            Trackable::_Release(_control);
+        }
 
-        switch (other._state) {
-            case STATE_NONE: {
-                break;
-            }
-            case STATE_SINGLE: {
-                _GetSingle() = std::move(other._GetSingle());
-                other._Reset();
-                break;
-            }
-            case STATE_LIST: {
-                _GetList() = std::move(other._GetList());
-                other._Reset();
-                break;
-            }
+        /**
+         * @brief  获取句柄指向的对象
+         * @return 对象存活时返回其指针，否则返回nullptr
+         */
+        Trackable *Get() const noexcept
+        {
+            return _control == nullptr ? nullptr : _control->owner.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief 判断句柄指向的对象是否存活
+         */
+        bool IsAlive() const noexcept
+        {
+            return Get() != nullptr;
+        }
+
+        /**
+         * @brief 获取句柄的哈希值，在对象析构后保持不变
+         */
+        size_t GetHashCode() const noexcept
+        {
+            return std::hash<const void *>()(_control);
+        }
+
+        /**
+         * @brief 判断两个句柄是否指向同一个对象
+         */
+        bool operator==(const WeakHandle &other) const noexcept
+        {
+            return _control == other._control;
         }
-        return *this;
-    }
+
+        /**
+         * @brief 判断两个句柄是否指向不同的对象
+         */
+        bool operator!=(const WeakHandle &other) const noexcept
+        {
+            return _control != other._control;
+        }
+    };
 
     /**
-     * @brief 析构函数
+     * @brief  获取指向当前对象的弱句柄
+     * @throw  std::bad_alloc 首次获取时分配控制块失败
      */
-    ~CallableList()
+    WeakHandle GetWeakHandle() const
     {
-        _Reset();
+        _Control *control = _control.load(std::memory_order_acquire);
+        if (control == nullptr) {
+            _Control *created = new _Control(const_cast<Trackable *>(this));
+            if (_control.compare_exchange_strong(control, created, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                control = created;
+            } else {
+                delete created;
+            }
+        }
+        return WeakHandle(control);
     }
 
+protected:
     /**
-     * @brief  获取当前存储的可调用对象数量
-     * @return 可调用对象的数量
+     * @brief 默认构造函数
      */
-    size_t Count() const noexcept
+    Trackable() noexcept
+        : _control(nullptr)
     {
-        switch (_state) {
-            case STATE_SINGLE: {
-                return 1;
-            }
-            case STATE_LIST: {
-                return _GetList().size();
-            }
-            default: {
-                return 0;
-            }
-        }
     }
 
     /**
-     * @brief  判断当前存储的可调用对象是否为空
-     * @return 如果没有存储任何可调用对象则返回true，否则返回false
+     * @brief 复制构造函数，新对象是独立的对象，不继承原对象的弱订阅
      */
-    bool IsEmpty() const noexcept
+    Trackable(const Trackable &) noexcept
+        : _control(nullptr)
     {
-        return _state == STATE_NONE;
     }
 
     /**
-     * @brief 清空当前存储的可调用对象
+     * @brief 赋值运算符，对象的弱订阅保持不变
      */
-    void Clear() noexcept
+    Trackable &operator=(const Trackable &) noexcept
     {
-        _Reset();
+        return *this;
     }
 
     /**
-     * @brief 添加一个可调用对象到列表中
-     * @note  传入对象的生命周期将由CallableList管理
+     * @brief 析构函数，使所有指向该对象的弱句柄失效
      */
-    void Add(TCallable *callable)
+    ~Trackable()
     {
-        if (callable == nullptr) {
-            return;
-        }
-
-        switch (_state) {
-            case STATE_NONE: {
-                _Reset(STATE_SINGLE);
-                _GetSingle().reset(callable);
-                break;
-            }
-            case STATE_SINGLE: {
-                TSharedList list;
-                list.emplace_back(_GetSingle().release());
-                list.emplace_back(callable);
-                _Reset(STATE_LIST);
-                _GetList() = std::move(list);
-                break;
-            }
-            case STATE_LIST: {
-                _GetList().emplace_back(callable);
-                break;
-            }
+        _Control *control = _control.load(std::memory_order_acquire);
+        if (control != nullptr) {
+            control->owner.store(nullptr, std::memory_order_release);
+            _Release(control);
         }
     }
 
+private:
     /**
-     * @brief  移除指定索引处的可调用对象
-     * @return 如果成功移除则返回true，否则返回false
+     * @brief 释放对控制块的引用
      */
-    bool RemoveAt(size_t index) noexcept
+    static void _Release(_Control *control) noexcept
     {
-        switch (_state) {
-            case STATE_SINGLE: {
-                if (index != 0) {
-                    return false;
-                } else {
-                    _Reset();
-                    return true;
-                }
-            }
-            case STATE_LIST: {
-                auto &list = _GetList();
-                if (index >= list.size()) {
-                    return false;
-                }
-                list.erase(list.begin() + index);
-                if (list.empty()) {
-                    _Reset();
-                }
-                // else if (list.size() == 1) {
-                //     auto ptr = list.front()->Clone();
-                //     _Reset(STATE_SINGLE);
-                //     _GetSingle().reset(ptr);
-                // }
-                return true;
-            }
-            default: {
-                return false;
-            }
+        if (control != nullptr && control->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete control;
         }
     }
+};
 
+/*================================================================================*/
+
+/**
+ * @brief 用于存储和管理多个可调用对象的列表，针对单个可调用对象的情况进行优化
+ */
+template <typename TRet, typename... Args>
+class CallableList<TRet(Args...)>
+{
+public:
     /**
-     * @brief  获取指定索引处的可调用对象
-     * @return 如果索引有效则返回对应的可调用对象，否则返回nullptr
+     * @brief 可调用对象类型别名
      */
-    TCallable *GetAt(size_t index) const noexcept
-    {
-        switch (_state) {
-            case STATE_SINGLE: {
-                return index == 0 ? _GetSingle().get() : nullptr;
-            }
-            case STATE_LIST: {
-                auto &list = _GetList();
-                return (index < list.size()) ? list[index].get() : nullptr;
-            }
-            default: {
-                return nullptr;
-            }
-        }
-    }
+    using TCallable = ICallable<TRet(Args...)>;
 
     /**
-     * @brief  获取指定索引处的可调用对象
-     * @return 如果索引有效则返回对应的可调用对象，否则返回nullptr
+     * @brief 与列表签名相同的函数指针类型
      */
-    TCallable *operator[](size_t index) const noexcept
+    using TFunction = TRet (*)(Args...);
+
+    /**
+     * @brief 判断可调用对象类型是否可以复制的辅助模板，包装类型可以通过静态成员IsCopyable声明所包装对象是否可以复制
+     * @note  不可复制的对象总是存储在堆对象中，复制列表时共享该堆对象，深拷贝时抛出异常
+     */
+    template <typename T, typename = void>
+    struct IsCopyable : std::is_copy_constructible<T> {
+    };
+
+    template <typename T>
+    struct IsCopyable<T, decltype(void(T::IsCopyable))> : std::integral_constant<bool, T::IsCopyable> {
+    };
+
+    /**
+     * @brief 判断可调用对象类型是否可以直接存储在CallableList内部的辅助模板
+     */
+    template <typename TWrapper>
+    struct IsInlineStorable
+        : std::integral_constant<bool,
+                                 sizeof(TWrapper) <= DELEGATE_INLINE_SIZE &&
+                                     alignof(TWrapper) <= alignof(void *) &&
+                                     std::is_nothrow_move_constructible<TWrapper>::value &&
+                                     IsCopyable<TWrapper>::value> {
+    };
+
+    /**
+     * @brief 判断可调用对象是否可能在调用时修改自身状态的辅助模板，包装类型可以通过静态成员HasMutableState声明
+     * @note  默认认为对象没有可变状态
+     */
+    template <typename T, typename = void>
+    struct HasMutableState : std::false_type {
+    };
+
+    template <typename T>
+    struct HasMutableState<T, decltype(void(T::HasMutableState))> : std::integral_constant<bool, T::HasMutableState> {
+    };
+
+    /**
+     * @brief 判断可调用对象是否直接存储在列表内部的辅助模板
+     * @note  复制列表时，存储在列表内部的对象被复制，堆对象被共享。有可变状态的对象总是存储在堆对象中，
+     *        因此无论列表处于何种状态，复制得到的列表都与原列表共享这些对象的状态；其余对象的副本与原对象不可区分
+     */
+    template <typename TWrapper>
+    struct IsStoredInline
+        : std::integral_constant<bool, IsInlineStorable<TWrapper>::value && !HasMutableState<TWrapper>::value> {
+    };
+
+    /**
+     * @brief 判断可调用对象类型是否提供IsExpired函数的辅助模板，这类对象失效后可以通过RemoveExpired移除
+     */
+    template <typename T, typename = void>
+    struct HasExpiry : std::false_type {
+    };
+
+    template <typename T>
+    struct HasExpiry<T, decltype(void(std::declval<const T &>().IsExpired()))> : std::true_type {
+    };
+
+    /**
+     * @brief 判断可调用对象类型是否提供GetTarget函数的辅助模板，这类对象可以通过RemoveTarget按绑定的对象移除
+     */
+    template <typename T, typename = void>
+    struct HasTarget : std::false_type {
+    };
+
+    template <typename T>
+    struct HasTarget<T, decltype(void(std::declval<const T &>().GetTarget()))> : std::true_type {
+    };
+
+    /**
+     * @brief 参数的引用类型，调用过程中参数以引用的形式在各层之间传递，避免逐层复制或移动
+     */
+    template <typename T>
+    using TArgRef = typename std::remove_reference<T>::type &;
+
+    /**
+     * @brief 以转发的形式调用可调用对象，按值传递和右值引用的参数将被移动
+     * @note  仅用于最后一个被调用的对象
+     */
+    template <typename F>
+    static TRet InvokeForward(F &f, TArgRef<Args>... args)
     {
-        return GetAt(index);
+        return f(static_cast<Args &&>(args)...);
     }
 
-private:
     /**
-     * @brief 内部函数，当状态为STATE_SINGLE时返回单个可调用对象的引用，
+     * @brief 以共享的形式调用可调用对象，参数不会被移动，用于最后一个之外的对象
+     * @note  若可调用对象接受常量左值则直接传递参数的引用，否则为按值传递和右值引用的参数创建副本
      */
-    constexpr TSinglePtr &_GetSingle() const noexcept
+    template <typename F>
+    static TRet InvokeShared(F &f, TArgRef<Args>... args)
     {
-        return *reinterpret_cast<TSinglePtr *>(_data._single);
+        return _InvokeShared(f, _IsSharable<F &>(), args...);
     }
 
     /**
-     * @brief 内部函数，当状态为STATE_LIST时返回可调用对象列表的引用
+     * @brief 为最后一个之外的对象准备参数：左值引用参数原样传递，其余参数传递副本
      */
-    constexpr TSharedList &_GetList() const noexcept
+    template <typename T>
+    static typename std::enable_if<std::is_lvalue_reference<T>::value, T>::type
+    CopyArg(TArgRef<T> arg)
     {
-        return *reinterpret_cast<TSharedList *>(_data._list);
+        return arg;
     }
 
     /**
-     * @brief 重置当前状态，释放存储的可调用对象
+     * @brief 为最后一个之外的对象准备参数：左值引用参数原样传递，其余参数传递副本
      */
-    void _Reset() noexcept
+    template <typename T>
+    static typename std::enable_if<!std::is_lvalue_reference<T>::value &&
+                                       std::is_copy_constructible<typename std::decay<T>::type>::value,
+                                   typename std::decay<T>::type>::type
+    CopyArg(TArgRef<T> arg)
     {
-        switch (_state) {
-            case STATE_NONE: {
-                break;
-            }
-            case STATE_SINGLE: {
-                _GetSingle().~TSinglePtr();
-                _state = STATE_NONE;
-                break;
-            }
-            case STATE_LIST: {
-                _GetList().~TSharedList();
-                _state = STATE_NONE;
-                break;
-            }
-        }
+        return arg;
     }
 
     /**
-     * @brief 重置当前状态并根据给定状态进行初始化
+     * @brief 为最后一个之外的对象准备参数，不可复制的参数只能被移动
      */
-    void _Reset(uint8_t state) noexcept
+    template <typename T>
+    static typename std::enable_if<!std::is_lvalue_reference<T>::value &&
+                                       !std::is_copy_constructible<typename std::decay<T>::type>::value,
+                                   T &&>::type
+    CopyArg(TArgRef<T> arg)
     {
-        _Reset();
-
-        switch (state) {
-            case STATE_SINGLE: {
-                new (_data._single) TSinglePtr();
-                _state = STATE_SINGLE;
-                break;
-            }
-            case STATE_LIST: {
-                new (_data._list) TSharedList();
-                _state = STATE_LIST;
-                break;
-            }
-        }
+        return static_cast<T &&>(arg);
     }
-};
 
-/*================================================================================*/
-
-/**
- * @brief 委托类，类似于C#中的委托，支持存储和调用任意可调用对象
- */
-template <typename TRet, typename... Args>
-class Delegate<TRet(Args...)> final : public ICallable<TRet(Args...)>
-{
 private:
-    using _ICallable = ICallable<TRet(Args...)>;
+    /**
+     * @brief 共享形式下参数的传递类型，左值引用参数原样传递，其余参数以常量左值传递
+     */
+    template <typename T>
+    using _SharedArg = typename std::conditional<std::is_lvalue_reference<T>::value, T,
+                                                 const typename std::remove_reference<T>::type &>::type;
 
-    template <typename T, typename = void>
-    struct _IsEqualityComparable : std::false_type {
+    /**
+     * @brief 判断可调用对象是否可以以共享的形式调用的辅助模板
+     */
+    template <typename F, typename = void>
+    struct _IsSharable : std::false_type {
     };
 
-    template <typename T>
-    struct _IsEqualityComparable<
-        T, decltype(void(std::declval<T>() == std::declval<T>()))> : std::true_type {
+    template <typename F>
+    struct _IsSharable<F, decltype(void(std::declval<F>()(std::declval<_SharedArg<Args>>()...)))>
+        : std::true_type {
     };
 
-    template <typename T, typename = void>
-    struct _IsMemcmpSafe : std::false_type {
-    };
+    template <typename F>
+    static TRet _InvokeShared(F &f, std::true_type, TArgRef<Args>... args)
+    {
+        return f(static_cast<_SharedArg<Args>>(args)...);
+    }
 
-    template <typename T>
-    struct _IsMemcmpSafe<
-        T,
-        typename std::enable_if</*std::is_trivial<T>::value &&*/ std::is_standard_layout<T>::value, void>::type> : std::true_type {
-    };
+    template <typename F>
+    static TRet _InvokeShared(F &f, std::false_type, TArgRef<Args>... args)
+    {
+        return f(CopyArg<Args>(args)...);
+    }
 
-    template <typename T>
-    class _CallableWrapperImpl final : public _ICallable
+    // StaticDelegate直接使用存储槽保存可调用对象
+    template <typename, size_t>
+    friend class StaticDelegate;
+
+#if defined(DELEGATE_HAS_MEMORY_RESOURCE)
+    using _Resource = std::pmr::memory_resource;
+#else
+    struct _Resource;
+#endif
+
+    /**
+     * @brief 从指定的内存资源分配内存，resource为nullptr时使用全局operator new
+     */
+    static void *_Allocate(_Resource *resource, size_t size)
     {
-        alignas(T) mutable uint8_t _storage[sizeof(T)];
+#if defined(DELEGATE_HAS_MEMORY_RESOURCE)
+        if (resource != nullptr) {
+            return resource->allocate(size);
+        }
+#endif
+        (void)resource;
+        return ::operator new(size);
+    }
 
-    public:
-        _CallableWrapperImpl(const T &value)
-        {
-            memset(_storage, 0, sizeof(_storage));
-            new (_storage) T(value);
+    /**
+     * @brief 释放由_Allocate分配的内存
+     */
+    static void _Deallocate(_Resource *resource, void *memory, size_t size) noexcept
+    {
+#if defined(DELEGATE_HAS_MEMORY_RESOURCE)
+        if (resource != nullptr) {
+            if (memory != nullptr) resource->deallocate(memory, size);
+            return;
         }
-        _CallableWrapperImpl(T &&value)
+#endif
+        (void)resource;
+        (void)size;
+        ::operator delete(memory);
+    }
+
+    /**
+     * @brief 单个可调用对象的存储槽，较小的可调用对象直接构造在槽内，
+     *        否则存储在带引用计数的堆对象中，复制存储槽时共享该堆对象
+     * @note  存储槽同时保存一个针对具体类型的调用函数，调用时无需经过虚函数
+     */
+    class _Slot
+    {
+        /**
+         * @brief 调用函数指针类型
+         */
+        using _InvokeFunc = TRet (*)(const TCallable *, bool, TArgRef<Args>...);
+
+        /**
+         * @brief 已知具体类型时的调用函数，可被内联展开
+         * @note  forward为true时转发参数，否则以共享的形式传递参数
+         */
+        template <typename TWrapper>
+        static TRet _InvokeDirect(const TCallable *callable, bool forward, TArgRef<Args>... args)
         {
-            memset(_storage, 0, sizeof(_storage));
-            new (_storage) T(std::move(value));
+            return static_cast<const TWrapper *>(callable)->InvokeWith(forward, args...);
         }
-        virtual ~_CallableWrapperImpl()
+
+        /**
+         * @brief 未知具体类型时的调用函数，通过虚函数调用
+         */
+        static TRet _InvokeVirtual(const TCallable *callable, bool forward, TArgRef<Args>... args)
         {
-            GetValue().~T();
-            // memset(_storage, 0, sizeof(_storage));
+            if (forward) return callable->Invoke(static_cast<Args &&>(args)...);
+            return callable->Invoke(CopyArg<Args>(args)...);
         }
-        T &GetValue() const noexcept
+
+        /**
+         * @brief 判断对象是否已失效的函数指针类型
+         */
+        using _ExpiredFunc = bool (*)(const TCallable *);
+
+        /**
+         * @brief 已知具体类型时判断对象是否已失效的函数
+         */
+        template <typename TWrapper>
+        static bool _IsExpired(const TCallable *callable) noexcept
         {
-            return *reinterpret_cast<T *>(_storage);
+            return static_cast<const TWrapper *>(callable)->IsExpired();
         }
-        TRet Invoke(Args... args) const override
+
+        /**
+         * @brief 获取判断对象是否已失效的函数，对象不会失效时返回nullptr
+         */
+        template <typename TWrapper>
+        static constexpr _ExpiredFunc _GetExpiredFunc(std::true_type) noexcept
         {
-            return GetValue()(std::forward<Args>(args)...);
+            return &_IsExpired<TWrapper>;
         }
-        _ICallable *Clone() const override
+
+        template <typename TWrapper>
+        static constexpr _ExpiredFunc _GetExpiredFunc(std::false_type) noexcept
         {
-            return new _CallableWrapperImpl(GetValue());
+            return nullptr;
         }
-        virtual std::type_index GetType() const override
+
+        /**
+         * @brief 获取对象所绑定的目标对象地址的函数指针类型
+         */
+        using _TargetFunc = const void *(*)(const TCallable *);
+
+        /**
+         * @brief 已知具体类型时获取对象所绑定的目标对象地址的函数
+         */
+        template <typename TWrapper>
+        static const void *_GetTarget(const TCallable *callable) noexcept
         {
-            return typeid(T);
+            return static_cast<const TWrapper *>(callable)->GetTarget();
         }
-        bool Equals(const _ICallable &other) const override
+
+        /**
+         * @brief 获取取得目标对象地址的函数，对象没有绑定目标对象时返回nullptr
+         */
+        template <typename TWrapper>
+        static constexpr _TargetFunc _GetTargetFunc(std::true_type) noexcept
         {
-            return EqualsImpl(other);
+            return &_GetTarget<TWrapper>;
         }
-        template <typename U = T>
-        typename std::enable_if<_IsEqualityComparable<U>::value, bool>::type
-        EqualsImpl(const _ICallable &other) const
+
+        template <typename TWrapper>
+        static constexpr _TargetFunc _GetTargetFunc(std::false_type) noexcept
         {
-            if (this == &other) {
-                return true;
+            return nullptr;
+        }
+
+        /**
+         * @brief 存储槽中对象的操作表
+         */
+        struct _Ops {
+            TCallable *(*copy)(void *dst, const void *src);                       // 复制对象，堆对象仅增加引用计数
+            TCallable *(*clone)(void *dst, const void *src, _Resource *resource); // 深拷贝对象，新的堆对象从resource分配
+            TCallable *(*move)(void *dst, void *src);                             // 移动对象并销毁原对象
+            void (*destroy)(void *storage);
+            _ExpiredFunc expired;                                                 // 判断对象是否已失效，为nullptr时表示对象不会失效
+            _TargetFunc target;                                                   // 获取对象绑定的目标对象，为nullptr时表示没有目标对象
+        };
+
+        /**
+         * @brief 内联对象的操作
+         */
+        template <typename TWrapper>
+        struct _InlineOps {
+            static TCallable *Copy(void *dst, const void *src)
+            {
+                return new (dst) TWrapper(*reinterpret_cast<const TWrapper *>(src));
             }
-            if (GetType() != other.GetType()) {
-                return false;
+            static TCallable *Clone(void *dst, const void *src, _Resource *)
+            {
+                return Copy(dst, src);
             }
-            const auto &otherWrapper = static_cast<const _CallableWrapperImpl &>(other);
-            return GetValue() == otherWrapper.GetValue();
-        }
-        template <typename U = T>
-        typename std::enable_if<!_IsEqualityComparable<U>::value && _IsMemcmpSafe<U>::value, bool>::type
-        EqualsImpl(const _ICallable &other) const
-        {
-            if (this == &other) {
-                return true;
+            static TCallable *Move(void *dst, void *src)
+            {
+                auto &wrapper = *reinterpret_cast<TWrapper *>(src);
+                auto result   = new (dst) TWrapper(std::move(wrapper));
+                wrapper.~TWrapper();
+                return result;
             }
-            if (GetType() != other.GetType()) {
-                return false;
+            static void Destroy(void *storage)
+            {
+                reinterpret_cast<TWrapper *>(storage)->~TWrapper();
             }
-            const auto &otherWrapper = static_cast<const _CallableWrapperImpl &>(other);
-            return memcmp(_storage, otherWrapper._storage, sizeof(_storage)) == 0;
-        }
-        template <typename U = T>
-        typename std::enable_if<!_IsEqualityComparable<U>::value && !_IsMemcmpSafe<U>::value, bool>::type
-        EqualsImpl(const _ICallable &other) const
-        {
-            return this == &other;
-        }
-    };
+            static const _Ops *Get() noexcept
+            {
+                static const _Ops ops = {&Copy, &Clone, &Move, &Destroy, _GetExpiredFunc<TWrapper>(HasExpiry<TWrapper>()),
+                                         _GetTargetFunc<TWrapper>(HasTarget<TWrapper>())};
+                return &ops;
+            }
+        };
+
+        /**
+         * @brief 堆对象，THolder为可调用对象或持有可调用对象的智能指针
+         */
+        template <typename THolder>
+        struct _Box {
+            std::atomic<size_t> refs;
+            _Resource *resource; // 分配该对象的内存资源
+            THolder value;
+
+            template <typename... CtorArgs>
+            _Box(_Resource *resource, CtorArgs &&...args)
+                : refs(1), resource(resource), value(std::forward<CtorArgs>(args)...)
+            {
+            }
+
+            /**
+             * @brief 从指定的内存资源创建堆对象
+             */
+            template <typename... CtorArgs>
+            static _Box *Create(_Resource *resource, CtorArgs &&...args)
+            {
+#if defined(DELEGATE_HAS_MEMORY_RESOURCE)
+                if (resource != nullptr) {
+                    void *memory = resource->allocate(sizeof(_Box), alignof(_Box));
+                    try {
+                        return new (memory) _Box(resource, std::forward<CtorArgs>(args)...);
+                    } catch (...) {
+                        resource->deallocate(memory, sizeof(_Box), alignof(_Box));
+                        throw;
+                    }
+                }
+#endif
+                return new _Box(resource, std::forward<CtorArgs>(args)...);
+            }
+
+            /**
+             * @brief 销毁堆对象并归还内存
+             */
+            static void Free(_Box *box) noexcept
+            {
+#if defined(DELEGATE_HAS_MEMORY_RESOURCE)
+                if (box->resource != nullptr) {
+                    _Resource *resource = box->resource;
+                    box->~_Box();
+                    resource->deallocate(box, sizeof(_Box), alignof(_Box));
+                    return;
+                }
+#endif
+                delete box;
+            }
+            TCallable *Get() noexcept
+            {
+                return _Get(value);
+            }
+            static TCallable *_Get(TCallable &callable) noexcept
+            {
+                return &callable;
+            }
+            static TCallable *_Get(const std::unique_ptr<TCallable> &callable) noexcept
+            {
+                return callable.get();
+            }
+        };
+
+        /**
+         * @brief 堆对象的操作
+         */
+        template <typename THolder>
+        struct _BoxOps {
+            using TBox = _Box<THolder>;
+
+            // 接管的ICallable对象通过其Clone函数复制
+            using _IsClonable = std::integral_constant<bool, IsCopyable<THolder>::value ||
+                                                                 std::is_same<THolder, std::unique_ptr<TCallable>>::value>;
+
+            static TBox *&Ref(void *storage) noexcept
+            {
+                return *reinterpret_cast<TBox **>(storage);
+            }
+            static TBox *Ref(const void *storage) noexcept
+            {
+                return *reinterpret_cast<TBox *const *>(storage);
+            }
+            static TCallable *Copy(void *dst, const void *src)
+            {
+                TBox *box = Ref(src);
+                box->refs.fetch_add(1, std::memory_order_relaxed);
+                return (new (dst) TBox *(box), box->Get());
+            }
+            static TCallable *Clone(void *dst, const void *src, _Resource *resource)
+            {
+                return _Clone(dst, src, resource, _IsClonable());
+            }
+            static TCallable *Move(void *dst, void *src)
+            {
+                TBox *box = Ref(src);
+                return (new (dst) TBox *(box), box->Get());
+            }
+            static void Destroy(void *storage)
+            {
+                TBox *box = Ref(storage);
+                if (box->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    TBox::Free(box);
+                }
+            }
+            static const _Ops *Get() noexcept
+            {
+                static const _Ops ops = {&Copy, &Clone, &Move, &Destroy, _GetExpiredFunc<THolder>(HasExpiry<THolder>()),
+                                         _GetTargetFunc<THolder>(HasTarget<THolder>())};
+                return &ops;
+            }
+            static TCallable *_Clone(void *dst, const void *src, _Resource *resource, std::true_type)
+            {
+                TBox *box = TBox::Create(resource, _CloneValue(Ref(src)->value));
+                return (new (dst) TBox *(box), box->Get());
+            }
+            static TCallable *_Clone(void *, const void *, _Resource *, std::false_type)
+            {
+                throw std::runtime_error("Callable is not copyable");
+            }
+            static const THolder &_CloneValue(const TCallable &callable)
+            {
+                return static_cast<const THolder &>(callable);
+            }
+            static std::unique_ptr<TCallable> _CloneValue(const std::unique_ptr<TCallable> &callable)
+            {
+                return std::unique_ptr<TCallable>(callable->Clone());
+            }
+        };
+
+        /**
+         * @brief 调用函数
+         */
+        _InvokeFunc _invoke = nullptr;
+
+        /**
+         * @brief 指向存储的可调用对象
+         */
+        TCallable *_callable = nullptr;
+
+        /**
+         * @brief 对象的操作表，为nullptr时表示存储槽为空
+         */
+        const _Ops *_ops = nullptr;
+
+        /**
+         * @brief 内联存储空间，或指向堆对象的指针
+         */
+        alignas(void *) uint8_t _storage[DELEGATE_INLINE_SIZE];
+
+    public:
+        /**
+         * @brief 对象在所属内存块令牌表中的句柄（索引+1），为0时表示没有令牌，由内存块维护
+         */
+        uint32_t handle = 0;
+
+        /**
+         * @brief 对象的优先级，随对象一起复制和移动；对象被移除后保留原值，因此空槽不破坏列表的有序性
+         */
+        int32_t priority = 0;
+
+        _Slot() noexcept
+        {
+        }
+
+        _Slot(const _Slot &other)
+        {
+            CopyFrom(other);
+        }
+
+        _Slot(_Slot &&other) noexcept
+        {
+            MoveFrom(other);
+        }
+
+        _Slot &operator=(const _Slot &) = delete;
+        _Slot &operator=(_Slot &&)      = delete;
+
+        ~_Slot()
+        {
+            Reset();
+        }
+
+        bool IsEmpty() const noexcept
+        {
+            return _callable == nullptr;
+        }
+
+        TCallable *Get() const noexcept
+        {
+            return _callable;
+        }
+
+        TRet Invoke(bool forward, TArgRef<Args>... args) const
+        {
+            return _invoke(_callable, forward, args...);
+        }
+
+        /**
+         * @brief 判断存储的对象是否已失效，空槽和不会失效的对象返回false
+         */
+        bool IsExpired() const noexcept
+        {
+            return _ops != nullptr && _ops->expired != nullptr && _ops->expired(_callable);
+        }
+
+        /**
+         * @brief 获取存储的对象所绑定的目标对象地址（见HasTarget），空槽和没有目标对象的对象返回nullptr
+         */
+        const void *GetTarget() const noexcept
+        {
+            return _ops != nullptr && _ops->target != nullptr ? _ops->target(_callable) : nullptr;
+        }
+
+        /**
+         * @brief 构造一个可调用对象，满足IsStoredInline的对象直接构造在槽内，否则从resource分配堆对象
+         */
+        template <typename TWrapper, typename... CtorArgs>
+        typename std::enable_if<IsStoredInline<TWrapper>::value, void>::type
+        Emplace(_Resource *, CtorArgs &&...args)
+        {
+            EmplaceInline<TWrapper>(std::forward<CtorArgs>(args)...);
+        }
+
+        /**
+         * @brief 构造一个可调用对象，满足IsStoredInline的对象直接构造在槽内，否则从resource分配堆对象
+         */
+        template <typename TWrapper, typename... CtorArgs>
+        typename std::enable_if<!IsStoredInline<TWrapper>::value, void>::type
+        Emplace(_Resource *resource, CtorArgs &&...args)
+        {
+            EmplaceBoxed<TWrapper>(resource, std::forward<CtorArgs>(args)...);
+        }
+
+        /**
+         * @brief 直接在槽内构造一个可调用对象，对象需满足IsInlineStorable
+         */
+        template <typename TWrapper, typename... CtorArgs>
+        void EmplaceInline(CtorArgs &&...args)
+        {
+            static_assert(IsInlineStorable<TWrapper>::value, "Callable cannot be stored inline");
+            Reset();
+            _callable = new (_storage) TWrapper(std::forward<CtorArgs>(args)...);
+            _invoke   = &_InvokeDirect<TWrapper>;
+            _ops      = _InlineOps<TWrapper>::Get();
+        }
+
+        /**
+         * @brief 从resource分配堆对象并在其中构造一个可调用对象
+         */
+        template <typename TWrapper, typename... CtorArgs>
+        void EmplaceBoxed(_Resource *resource, CtorArgs &&...args)
+        {
+            Reset();
+            auto box  = _Box<TWrapper>::Create(resource, std::forward<CtorArgs>(args)...);
+            _callable = (new (_storage) _Box<TWrapper> *(box), box->Get());
+            _invoke   = &_InvokeDirect<TWrapper>;
+            _ops      = _BoxOps<TWrapper>::Get();
+        }
+
+        /**
+         * @brief 接管一个堆上的可调用对象，持有该对象的堆对象从resource分配
+         */
+        void Assign(_Resource *resource, TCallable *callable)
+        {
+            Reset();
+            std::unique_ptr<TCallable> holder(callable);
+            auto box  = _Box<std::unique_ptr<TCallable>>::Create(resource, std::move(holder));
+            _callable = (new (_storage) _Box<std::unique_ptr<TCallable>> *(box), box->Get());
+            _invoke   = &_InvokeVirtual;
+            _ops      = _BoxOps<std::unique_ptr<TCallable>>::Get();
+        }
+
+        /**
+         * @brief 复制另一个存储槽中的对象，堆对象将被共享
+         */
+        void CopyFrom(const _Slot &other)
+        {
+            Reset();
+            if (other._ops != nullptr) {
+                _callable = other._ops->copy(_storage, other._storage);
+                _invoke   = other._invoke;
+                _ops      = other._ops;
+            }
+            priority = other.priority;
+        }
+
+        /**
+         * @brief 深拷贝另一个存储槽中的对象，新的堆对象从resource分配
+         */
+        void CloneFrom(const _Slot &other, _Resource *resource)
+        {
+            Reset();
+            if (other._ops != nullptr) {
+                _callable = other._ops->clone(_storage, other._storage, resource);
+                _invoke   = other._invoke;
+                _ops      = other._ops;
+            }
+            priority = other.priority;
+        }
+
+        /**
+         * @brief 将另一个存储槽中的对象移动到当前存储槽
+         */
+        void MoveFrom(_Slot &other) noexcept
+        {
+            Reset();
+            if (other._ops != nullptr) {
+                _callable       = other._ops->move(_storage, other._storage);
+                _invoke         = other._invoke;
+                _ops            = other._ops;
+                other._ops      = nullptr;
+                other._callable = nullptr;
+            }
+            handle       = other.handle;
+            other.handle = 0;
+            priority     = other.priority;
+        }
+
+        void Reset() noexcept
+        {
+            if (_ops != nullptr) {
+                _ops->destroy(_storage);
+                _invoke   = nullptr;
+                _callable = nullptr;
+                _ops      = nullptr;
+            }
+        }
+    };
+
+    /**
+     * @brief 令牌表中的句柄
+     */
+    struct _Handle {
+        uint32_t pos;    // 使用中时为对象在内存块中的位置，空闲时为下一个空闲句柄
+        uint32_t serial; // 分配时取全局唯一的非零序号，释放时清零，用于识别失效或其他委托的令牌
+    };
+
+    /**
+     * @brief 哈希索引中的条目
+     */
+    struct _IndexEntry {
+        size_t hash; // 可调用对象的哈希值
+        size_t pos;  // 对象在内存块中的位置，为SIZE_MAX时表示空条目
+    };
+
+    /**
+     * @brief 启用索引时，内存块中的对象数量达到该值才建立哈希索引，数量较少时线性查找更快
+     */
+    static constexpr size_t _INDEX_THRESHOLD = 16;
+
+    /**
+     * @brief 存储多个可调用对象的连续内存块，可在多个CallableList之间共享，修改时若被共享则先复制
+     * @note  移除对象时仅清空其存储槽，空槽在数量超过对象数量或内存块已满时被压缩，最后一个存储槽总是非空
+     */
+    struct _Block {
+        std::atomic<size_t> refs;
+        _Resource *resource;     // 分配该内存块及其附属表的内存资源
+        size_t count;            // 已使用的存储槽数量，包括空槽
+        size_t live;             // 非空存储槽的数量
+        size_t capacity;
+        _IndexEntry *index;      // 哈希索引，采用线性探测，容量至少为内存块容量的两倍
+        size_t indexMask;        // 哈希索引容量减一
+        _Handle *handles;        // 令牌表，首次获取令牌时分配
+        uint32_t handleCount;
+        uint32_t handleCapacity;
+        uint32_t freeHandle;     // 空闲句柄链表头（索引+1），为0时表示没有空闲句柄
+        std::atomic<bool> expired; // 调用期间发现了已失效的对象，下次添加对象前将其移除
+
+        _Slot *Slots() noexcept
+        {
+            return reinterpret_cast<_Slot *>(this + 1);
+        }
+    };
+
+    /**
+     * @brief 调用帧，记录当前线程上正在调用的CallableList
+     */
+    struct _InvokeFrame {
+        const CallableList *list;
+        _InvokeFrame *prev;
+        _Block *block;  // 正在遍历的内存块，STATE_LIST时有效
+        bool ownsBlock; // 调用期间列表已不再引用block，需在调用结束后释放
+        bool stale;     // 调用期间单个可调用对象已被移除，需在调用结束后销毁
+    };
+
+    /**
+     * @brief 单个可调用对象，仅在STATE_SINGLE时有效
+     * @note  调用期间被移除的对象会保留在此处直到调用结束
+     */
+    mutable _Slot _single;
+
+    union {
+        /**
+         * @brief 存储多个可调用对象的内存块；STATE_NONE时若不为nullptr则为通过Reserve预留的空内存块
+         */
+        _Block *_block = nullptr;
+
+        /**
+         * @brief STATE_SINGLE时，若_single是通过EmplaceFunction添加的函数指针则为该函数指针，否则为nullptr
+         */
+        TFunction _function;
+    };
+
+    /**
+     * @brief 当前状态枚举
+     */
+    enum : uint8_t {
+        STATE_NONE,   // 未存储任何可调用对象
+        STATE_SINGLE, // 储存了一个可调用对象
+        STATE_LIST,   // 储存了多个可调用对象
+    } _state = STATE_NONE;
+
+    /**
+     * @brief 是否为内存块建立哈希索引
+     */
+    bool _indexed = false;
+
+    /**
+     * @brief 分配内存块和堆对象使用的内存资源，为nullptr时使用全局operator new
+     */
+    _Resource *_resource = nullptr;
+
+public:
+    /**
+     * @brief 调用作用域，在调用存储的可调用对象期间于栈上创建，并通过该对象访问可调用对象
+     * @note  作用域存在期间，被调用的可调用对象修改列表不会影响正在进行的调用，
+     *        列表会在修改前复制正在遍历的内存块，被移除的对象在调用结束后才被销毁。
+     *        定义DELEGATE_DISABLE_SAFEINVOKE时不提供该保证，调用期间修改列表的行为未定义
+     */
+    class InvokeScope
+    {
+#if !defined(DELEGATE_DISABLE_SAFEINVOKE)
+        _InvokeFrame _frame;
+#endif
+        const _Slot *_slots;
+        size_t _count;
+        _Block *_block; // 正在遍历的内存块，STATE_LIST时有效，调用到已失效的对象时在其上标记
+
+        /**
+         * @brief 调用结束（包括抛出异常）时检查被调用的对象是否已失效，若失效则标记内存块
+         */
+        struct _ExpiryCheck {
+            _Block *block;
+            const _Slot &slot;
+
+            ~_ExpiryCheck()
+            {
+                if (block != nullptr && slot.IsExpired()) {
+                    block->expired.store(true, std::memory_order_relaxed);
+                }
+            }
+        };
+
+    public:
+        explicit InvokeScope(const CallableList &list) noexcept
+        {
+#if !defined(DELEGATE_DISABLE_SAFEINVOKE)
+            _frame.list      = &list;
+            _frame.prev      = _TopFrame();
+            _frame.block     = list._state == STATE_LIST ? list._block : nullptr;
+            _frame.ownsBlock = false;
+            _frame.stale     = false;
+            _TopFrame()      = &_frame;
+#endif
+
+            switch (list._state) {
+                case STATE_SINGLE: {
+                    _slots = &list._single;
+                    _count = 1;
+                    _block = nullptr;
+                    break;
+                }
+                case STATE_LIST: {
+                    _slots = list._block->Slots();
+                    _count = list._block->count;
+                    _block = list._block;
+                    break;
+                }
+                default: {
+                    _slots = nullptr;
+                    _count = 0;
+                    _block = nullptr;
+                    break;
+                }
+            }
+        }
+
+        ~InvokeScope()
+        {
+#if !defined(DELEGATE_DISABLE_SAFEINVOKE)
+            _TopFrame() = _frame.prev;
+            if (_frame.ownsBlock) {
+                _ReleaseBlock(_frame.block);
+            }
+            if (_frame.stale && _frame.list != nullptr) {
+                _frame.list->_single.Reset();
+            }
+#endif
+        }
+
+        InvokeScope(const InvokeScope &)            = delete;
+        InvokeScope &operator=(const InvokeScope &) = delete;
+
+        /**
+         * @brief 获取作用域创建时列表中存储槽的数量
+         * @note  被移除的对象可能留下空槽，但最后一个存储槽总是非空
+         */
+        size_t Count() const noexcept
+        {
+            return _count;
+        }
+
+        /**
+         * @brief 获取作用域创建时指定位置处的可调用对象，位置为空槽时返回nullptr
+         */
+        TCallable *operator[](size_t index) const noexcept
+        {
+            return _slots[index].Get();
+        }
+
+        /**
+         * @brief 调用作用域创建时指定位置处的可调用对象，调用者需保证该位置不是空槽
+         * @note  forward为true时转发参数（按值传递和右值引用的参数将被移动），仅应用于最后一个被调用的对象；
+         *        否则参数以共享的形式传递，可以安全地对多个对象使用同一组参数。
+         *        调用后对象已失效（见HasExpiry）时标记作用域持有的内存块，列表下次添加对象前移除失效的对象；
+         *        标记只依赖作用域本身，因此在其他线程上通过同一作用域调用（如InvokeAllParallel）时同样有效
+         */
+        TRet InvokeAt(size_t index, bool forward, TArgRef<Args>... args) const
+        {
+            _ExpiryCheck check = {_block, _slots[index]};
+            return _slots[index].Invoke(forward, args...);
+        }
+    };
+
+    /**
+     * @brief 默认构造函数
+     */
+    CallableList()
+    {
+    }
+
+#if defined(DELEGATE_HAS_MEMORY_RESOURCE)
+    /**
+     * @brief 构造函数，指定分配内存使用的内存资源
+     * @note  内存块和存储在堆上的可调用对象均从该资源分配，调用者需保证该资源的生命周期长于列表及其副本
+     */
+    explicit CallableList(std::pmr::memory_resource *resource) noexcept
+        : _resource(resource)
+    {
+    }
+#endif
+
+    /**
+     * @brief 拷贝构造函数，新列表使用与原列表相同的内存资源
+     */
+    CallableList(const CallableList &other)
+        : _resource(other._resource)
+    {
+        *this = other;
+    }
+
+    /**
+     * @brief 移动构造函数，新列表使用与原列表相同的内存资源
+     */
+    CallableList(CallableList &&other) noexcept
+        : _resource(other._resource)
+    {
+        *this = std::move(other);
+    }
+
+    /**
+     * @brief 拷贝赋值运算
+     * @note  STATE_LIST时两个列表共享同一内存块，内存资源不随赋值改变
+     */
+    CallableList &operator=(const CallableList &other)
+    {
+        if (this == &other) {
+            return *this;
+        }
+
+        _Reset();
+        _indexed = other._indexed;
+
+        switch (other._state) {
+            case STATE_NONE: {
+                break;
+            }
+            case STATE_SINGLE: {
+                _AddSlot(other._single, false, other._single.priority, other._function);
+                break;
+            }
+            case STATE_LIST: {
+                other._block->refs.fetch_add(1, std::memory_order_relaxed);
+                _block = other._block;
+                _state = STATE_LIST;
+                break;
+            }
+        }
+        return *this;
+    }
+
+    /**
+     * @brief 移动赋值运算
+     * @note  内存资源不随赋值改变，接管的内存块仍由分配它的内存资源释放
+     */
+    CallableList &operator=(CallableList &&other) noexcept
+    {
+        if (this == &other) {
+            return *this;
+        }
+
+        _Reset();
+
+        // 正在调用的列表需要保留其内容直到调用结束，此时退化为复制
+        if (other._FindFrame() != nullptr) {
+            *this = other;
+            other._Reset();
+            return *this;
+        }
+
+        _indexed = other._indexed;
+
+        switch (other._state) {
+            case STATE_NONE: {
+                break;
+            }
+            case STATE_SINGLE: {
+                if (_single.IsEmpty()) {
+                    _single.MoveFrom(other._single);
+                    _function = other._function;
+                    _state    = STATE_SINGLE;
+                } else {
+                    _AddSlot(other._single, false, other._single.priority, other._function);
+                }
+                other._Reset();
+                break;
+            }
+            case STATE_LIST: {
+                _block        = other._block;
+                _state        = STATE_LIST;
+                other._block  = nullptr;
+                other._state  = STATE_NONE;
+                break;
+            }
+        }
+        return *this;
+    }
+
+    /**
+     * @brief 析构函数
+     */
+    ~CallableList()
+    {
+        _Reset();
+        for (auto frame = _TopFrame(); frame != nullptr; frame = frame->prev) {
+            if (frame->list == this) frame->list = nullptr;
+        }
+    }
+
+    /**
+     * @brief  获取当前存储的可调用对象数量
+     * @return 可调用对象的数量
+     */
+    size_t Count() const noexcept
+    {
+        switch (_state) {
+            case STATE_SINGLE: {
+                return 1;
+            }
+            case STATE_LIST: {
+                return _block->live;
+            }
+            default: {
+                return 0;
+            }
+        }
+    }
+
+    /**
+     * @brief  判断当前存储的可调用对象是否为空
+     * @return 如果没有存储任何可调用对象则返回true，否则返回false
+     */
+    bool IsEmpty() const noexcept
+    {
+        return _state == STATE_NONE;
+    }
+
+    /**
+     * @brief 清空当前存储的可调用对象
+     */
+    void Clear() noexcept
+    {
+        _Reset();
+    }
+
+    /**
+     * @brief 预留至少能存储capacity个可调用对象的空间，之后添加对象时不再重新分配内存块
+     * @note  列表为空时预留的内存块在添加第一个对象时使用，此时第一个对象不再存储在列表内部；capacity不大于1时不做任何操作
+     */
+    void Reserve(size_t capacity)
+    {
+        if (capacity <= 1) {
+            return;
+        }
+        if (_state == STATE_NONE) {
+            if (_block == nullptr || _block->capacity < capacity) {
+                _Block *block = _AllocBlock(_resource, capacity);
+                if (_block != nullptr) _FreeBlock(_block);
+                _block = block;
+            }
+            return;
+        }
+        size_t count = Count();
+        _MakeBlockWritable(capacity > count ? capacity - count : 0);
+        if (_block->capacity < capacity) {
+            _Block *block = _RebuildBlock(_resource, _block, capacity, true);
+            _ReleaseBlock(_block);
+            _block = block;
+        }
+    }
+
+    /**
+     * @brief 释放多余的存储空间：去除内存块中的空槽并按实际数量重新分配，只剩一个对象时将其移回列表内部
+     * @note  持有令牌的对象不会被移回列表内部，以保证令牌仍然有效
+     */
+    void Compact()
+    {
+        switch (_state) {
+            case STATE_NONE: {
+                _Reset();
+                break;
+            }
+            case STATE_SINGLE: {
+                break;
+            }
+            case STATE_LIST: {
+                if (_block->live == 1 && _single.IsEmpty()) {
+                    _Slot &slot = *const_cast<_Slot *>(_GetSlot(0));
+                    if (slot.handle == 0) {
+                        if (_IsBlockWritable()) {
+                            _single.MoveFrom(slot);
+                        } else {
+                            _single.CopyFrom(slot);
+                        }
+                        _DetachBlock();
+                        _function = nullptr;
+                        _state    = STATE_SINGLE;
+                        break;
+                    }
+                }
+                if (_block->live < _block->capacity) {
+                    bool writable = _IsBlockWritable();
+                    _Block *block = _RebuildBlock(_resource, _block, _block->live, writable);
+                    if (writable) {
+                        _ReleaseBlock(_block);
+                    } else {
+                        _DetachBlock();
+                    }
+                    _block = block;
+                    _state = STATE_LIST;
+                }
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief          添加一个可调用对象到列表中
+     * @param priority 优先级，优先级高的对象先被调用，优先级相同的对象按添加顺序调用
+     * @return         新对象的索引，callable为nullptr时返回SIZE_MAX
+     * @note           传入对象的生命周期将由CallableList管理
+     */
+    size_t Add(TCallable *callable, int priority = 0)
+    {
+        if (callable == nullptr) {
+            return SIZE_MAX;
+        }
+
+        _RemoveReportedExpired();
+        if (_IsSingleAvailable()) {
+            _single.Assign(_resource, callable);
+            _single.priority = priority;
+            _function        = nullptr;
+            _state           = STATE_SINGLE;
+            return 0;
+        } else {
+            _AppendSlot().Assign(_resource, callable);
+            return _IndexOf(_CommitSlot(priority));
+        }
+    }
+
+    /**
+     * @brief  在列表中直接构造一个可调用对象，优先级为0
+     * @return 新对象的索引
+     * @note   满足IsStoredInline的对象直接存储在列表内部，不会单独产生堆分配
+     */
+    template <typename TWrapper, typename... CtorArgs>
+    size_t Emplace(CtorArgs &&...args)
+    {
+        return EmplaceWithPriority<TWrapper>(0, std::forward<CtorArgs>(args)...);
+    }
+
+    /**
+     * @brief          按优先级在列表中直接构造一个可调用对象
+     * @param priority 优先级，优先级高的对象先被调用，优先级相同的对象按添加顺序调用
+     * @return         新对象的索引
+     * @note           新对象的优先级不高于列表末尾的对象时直接追加；否则通过二分查找确定位置，并将其后的对象依次后移
+     */
+    template <typename TWrapper, typename... CtorArgs>
+    size_t EmplaceWithPriority(int priority, CtorArgs &&...args)
+    {
+        _RemoveReportedExpired();
+        if (_IsSingleAvailable()) {
+            _single.template Emplace<TWrapper>(_resource, std::forward<CtorArgs>(args)...);
+            _single.priority = priority;
+            _function        = nullptr;
+            _state           = STATE_SINGLE;
+            return 0;
+        } else {
+            _AppendSlot().template Emplace<TWrapper>(_resource, std::forward<CtorArgs>(args)...);
+            return _IndexOf(_CommitSlot(priority));
+        }
+    }
+
+    /**
+     * @brief          按优先级在列表中构造一个包装函数指针的可调用对象，TWrapper需可由func构造
+     * @param priority 优先级，优先级高的对象先被调用，优先级相同的对象按添加顺序调用
+     * @return         新对象的索引
+     * @note           列表只包含该对象时同时记录函数指针本身，调用者可以通过GetFunction直接调用而不经过包装对象
+     */
+    template <typename TWrapper>
+    size_t EmplaceFunction(int priority, TFunction func)
+    {
+        size_t index = EmplaceWithPriority<TWrapper>(priority, func);
+        if (_state == STATE_SINGLE) {
+            _function = func;
+        }
+        return index;
+    }
+
+    /**
+     * @brief  获取列表唯一存储的函数指针
+     * @return 若列表只包含一个通过EmplaceFunction添加的对象则返回其函数指针，否则返回nullptr
+     * @note   直接调用该函数指针等价于调用列表，且不需要创建调用作用域
+     */
+    TFunction GetFunction() const noexcept
+    {
+        return _state == STATE_SINGLE ? _function : nullptr;
+    }
+
+    /**
+     * @brief  将另一个列表中指定索引处的可调用对象的副本按指定优先级添加到列表中
+     * @return 新对象的索引，索引无效时返回SIZE_MAX
+     * @note   存储在堆上的可调用对象将被共享而不是复制
+     */
+    size_t AddCopy(const CallableList &other, size_t index, int priority = 0)
+    {
+        const _Slot *slot = other._GetSlot(index);
+        return slot == nullptr ? SIZE_MAX : _AddSlot(*slot, false, priority, other.GetFunction());
+    }
+
+    /**
+     * @brief  将另一个列表中指定索引处的可调用对象的深拷贝按指定优先级添加到列表中
+     * @return 新对象的索引，索引无效时返回SIZE_MAX
+     */
+    size_t AddClone(const CallableList &other, size_t index, int priority = 0)
+    {
+        const _Slot *slot = other._GetSlot(index);
+        return slot == nullptr ? SIZE_MAX : _AddSlot(*slot, true, priority, other.GetFunction());
+    }
+
+    /**
+     * @brief      将另一个列表中的所有可调用对象按顺序添加到列表中，对象保留各自的优先级
+     * @param deep 为true时添加深拷贝，否则存储在堆上的可调用对象将被共享
+     */
+    void Append(const CallableList &other, bool deep = false)
+    {
+        if (this == &other) {
+            CallableList source(other);
+            Append(source, deep);
+            return;
+        }
+
+        switch (other._state) {
+            case STATE_SINGLE: {
+                _AddSlot(other._single, deep, other._single.priority, other._function);
+                break;
+            }
+            case STATE_LIST: {
+                const _Slot *slots = other._block->Slots();
+                for (size_t i = 0; i < other._block->count; ++i) {
+                    if (!slots[i].IsEmpty()) _AddSlot(slots[i], deep, slots[i].priority);
+                }
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief  移除指定索引处的可调用对象
+     * @return 如果成功移除则返回true，否则返回false
+     */
+    bool RemoveAt(size_t index)
+    {
+        switch (_state) {
+            case STATE_SINGLE: {
+                if (index != 0) {
+                    return false;
+                } else {
+                    _Reset();
+                    return true;
+                }
+            }
+            case STATE_LIST: {
+                const _Slot *slot = _GetSlot(index);
+                if (slot == nullptr) {
+                    return false;
+                }
+                _RemoveSlot(slot - _block->Slots());
+                return true;
+            }
+            default: {
+                return false;
+            }
+        }
+    }
+
+    /**
+     * @brief  按照添加顺序从后向前查找第一个与给定对象相等的可调用对象并移除
+     * @return 如果成功移除则返回true，否则返回false
+     */
+    bool Remove(const TCallable &callable)
+    {
+        switch (_state) {
+            case STATE_SINGLE: {
+                if (!_single.Get()->Equals(callable)) {
+                    return false;
+                }
+                _Reset();
+                return true;
+            }
+            case STATE_LIST: {
+                size_t pos = _FindLast(callable);
+                if (pos == SIZE_MAX) {
+                    return false;
+                }
+                _RemoveSlot(pos);
+                return true;
+            }
+            default: {
+                return false;
+            }
+        }
+    }
+
+    /**
+     * @brief  查找与另一个列表中的对象依次相等的最后一段连续对象并将其移除，与C#中Delegate.Remove的规则相同
+     * @return 如果成功移除则返回true，否则返回false
+     */
+    bool RemoveSequence(const CallableList &other)
+    {
+        size_t count = other.Count();
+        size_t total = Count();
+        if (count == 0 || count > total) {
+            return false;
+        }
+        if (count == 1) {
+            return Remove(*other._GetSlot(0)->Get());
+        }
+
+        // 从后向前依次尝试以第start个对象开始的子序列，cur指向该对象
+        const _Slot *cur = _GetSlot(total - count);
+        for (size_t start = total - count;; --start) {
+            if (_MatchSlots(cur, other._Slots(), count)) {
+                size_t index = 0;
+                _RemoveIf([&](const _Slot &) {
+                    bool match = index >= start && index < start + count;
+                    ++index;
+                    return match;
+                });
+                return true;
+            }
+            if (start == 0) {
+                return false;
+            }
+            do {
+                --cur;
+            } while (cur->IsEmpty());
+        }
+    }
+
+    /**
+     * @brief  移除所有已失效的可调用对象（见HasExpiry）
+     * @return 被移除的对象数量
+     */
+    size_t RemoveExpired()
+    {
+        if (_state == STATE_LIST) {
+            _block->expired.store(false, std::memory_order_relaxed);
+        }
+        return _RemoveIf([](const _Slot &slot) { return slot.IsExpired(); });
+    }
+
+    /**
+     * @brief  移除所有满足条件的可调用对象，pred接受const TCallable &并返回bool，调用期间不应修改列表
+     * @return 被移除的对象数量
+     * @note   只遍历一次列表，被移除的对象留下的空槽在遍历结束后统一处理
+     */
+    template <typename TPred>
+    size_t RemoveIf(TPred pred)
+    {
+        return _RemoveIf([&pred](const _Slot &slot) { return static_cast<bool>(pred(*slot.Get())); });
+    }
+
+    /**
+     * @brief  移除所有绑定到指定目标对象的可调用对象（见HasTarget）
+     * @return 被移除的对象数量
+     */
+    size_t RemoveTarget(const void *target)
+    {
+        if (target == nullptr) {
+            return 0;
+        }
+        return _RemoveIf([target](const _Slot &slot) { return slot.GetTarget() == target; });
+    }
+
+    /**
+     * @brief  判断列表中是否存在与给定对象相等的可调用对象
+     * @return 如果存在则返回true，否则返回false
+     */
+    bool Contains(const TCallable &callable) const
+    {
+        switch (_state) {
+            case STATE_SINGLE: {
+                return _single.Get()->Equals(callable);
+            }
+            case STATE_LIST: {
+                return _FindLast(callable) != SIZE_MAX;
+            }
+            default: {
+                return false;
+            }
+        }
+    }
+
+    /**
+     * @brief 设置是否为存储的可调用对象建立哈希索引
+     * @note  启用后，对象数量较多时Remove和Contains的平均代价为O(1)，但添加和移除对象需要额外维护索引；
+     *        该设置在复制列表时一并复制
+     */
+    void SetIndexed(bool indexed)
+    {
+        _indexed = indexed;
+        if (_state != STATE_LIST) {
+            return;
+        }
+        if (indexed && _block->index == nullptr && _block->live >= _INDEX_THRESHOLD) {
+            _MakeBlockWritable(0);
+            if (_block->index == nullptr) {
+                _AllocIndex(_block);
+                _RefillIndex(_block);
+            }
+        } else if (!indexed && _block->index != nullptr && _IsBlockWritable()) {
+            _Deallocate(_block->resource, _block->index, (_block->indexMask + 1) * sizeof(_IndexEntry));
+            _block->index     = nullptr;
+            _block->indexMask = 0;
+        }
+    }
+
+    /**
+     * @brief 判断是否启用了哈希索引
+     */
+    bool IsIndexed() const noexcept
+    {
+        return _indexed;
+    }
+
+    /**
+     * @brief 使用与另一个列表相同的内存资源和索引设置，不改变列表中的内容
+     */
+    void CopySettings(const CallableList &other) noexcept
+    {
+        _resource = other._resource;
+        _indexed  = other._indexed;
+    }
+
+#if defined(DELEGATE_HAS_MEMORY_RESOURCE)
+    /**
+     * @brief 获取分配内存使用的内存资源，为nullptr时表示使用全局operator new
+     */
+    std::pmr::memory_resource *GetMemoryResource() const noexcept
+    {
+        return _resource;
+    }
+#endif
+
+    /**
+     * @brief  移除令牌对应的可调用对象
+     * @return 如果令牌有效且成功移除则返回true，否则返回false
+     */
+    bool Remove(SubscriptionToken token)
+    {
+        size_t pos = _FindHandle(token);
+        if (pos == SIZE_MAX) {
+            return false;
+        }
+        _RemoveSlot(pos);
+        return true;
+    }
+
+    /**
+     * @brief  获取指定索引处可调用对象的令牌，之后可通过令牌直接移除该对象而无需查找
+     * @return 如果索引有效则返回对应的令牌，否则返回空令牌
+     * @note   令牌保存在内存块中，获取令牌后列表总是使用内存块存储；
+     *         最后一个对象（如刚追加的对象）的令牌可直接获取，不需要跳过内存块中的空槽查找
+     */
+    SubscriptionToken GetToken(size_t index)
+    {
+        if (index >= Count()) {
+            return SubscriptionToken();
+        }
+
+        _MakeBlockWritable(0);
+        _Slot *slot = const_cast<_Slot *>(_GetSlot(index));
+        if (slot->handle == 0) {
+            slot->handle = _AllocHandle(_block, slot - _block->Slots());
+        }
+        uint64_t serial = _block->handles[slot->handle - 1].serial;
+        return SubscriptionToken((serial << 32) | slot->handle);
+    }
+
+    /**
+     * @brief  判断两个列表是否按相同顺序存储了相等的可调用对象
+     * @return 如果相等则返回true，否则返回false
+     */
+    bool SequenceEqual(const CallableList &other) const
+    {
+        TFunction function = GetFunction();
+        if (function != nullptr && other.GetFunction() != nullptr) {
+            return function == other.GetFunction();
+        }
+        size_t count = Count();
+        if (count != other.Count()) {
+            return false;
+        }
+        return _MatchSlots(_Slots(), other._Slots(), count);
+    }
+
+    /**
+     * @brief 按顺序组合所有可调用对象的哈希值，与SequenceEqual相对应
+     */
+    size_t SequenceHash() const noexcept
+    {
+        size_t count     = Count();
+        size_t hash      = 0;
+        const _Slot *cur = _Slots();
+        for (size_t i = 0; i < count; ++i, ++cur) {
+            while (cur->IsEmpty()) ++cur;
+            hash = hash * 31 + cur->Get()->GetHashCode();
+        }
+        return hash;
+    }
+
+    /**
+     * @brief  获取指定索引处的可调用对象
+     * @return 如果索引有效则返回对应的可调用对象，否则返回nullptr
+     */
+    TCallable *GetAt(size_t index) const noexcept
+    {
+        const _Slot *slot = _GetSlot(index);
+        return slot == nullptr ? nullptr : slot->Get();
+    }
+
+    /**
+     * @brief  获取指定索引处的可调用对象
+     * @return 如果索引有效则返回对应的可调用对象，否则返回nullptr
+     */
+    TCallable *operator[](size_t index) const noexcept
+    {
+        return GetAt(index);
+    }
+
+    /**
+     * @brief 调用指定索引处的可调用对象，调用者需保证索引有效
+     * @note  该函数不经过虚函数调用具体类型的Invoke
+     */
+    TRet InvokeAt(size_t index, Args... args) const
+    {
+        return _GetSlot(index)->Invoke(true, args...);
+    }
+
+private:
+    /**
+     * @brief 内部函数，获取当前线程的调用帧链表头
+     */
+    static _InvokeFrame *&_TopFrame() noexcept
+    {
+        static thread_local _InvokeFrame *top = nullptr;
+        return top;
+    }
+
+    /**
+     * @brief 内部函数，查找当前线程上调用该列表的最外层调用帧
+     */
+    _InvokeFrame *_FindFrame() const noexcept
+    {
+        _InvokeFrame *result = nullptr;
+        for (auto frame = _TopFrame(); frame != nullptr; frame = frame->prev) {
+            if (frame->list == this) result = frame;
+        }
+        return result;
+    }
+
+    /**
+     * @brief 内部函数，获取存储槽数组的起始位置，STATE_NONE时无意义
+     */
+    const _Slot *_Slots() const noexcept
+    {
+        return _state == STATE_LIST ? _block->Slots() : &_single;
+    }
+
+    /**
+     * @brief 内部函数，判断分别从a和b开始的count个对象是否依次相等，比较时跳过空槽
+     */
+    static bool _MatchSlots(const _Slot *a, const _Slot *b, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i, ++a, ++b) {
+            while (a->IsEmpty()) ++a;
+            while (b->IsEmpty()) ++b;
+            if (!a->Get()->Equals(*b->Get())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 内部函数，获取指定索引处的存储槽，内存块中存在空槽时需逐个查找
+     */
+    const _Slot *_GetSlot(size_t index) const noexcept
+    {
+        switch (_state) {
+            case STATE_SINGLE: {
+                return index == 0 ? &_single : nullptr;
+            }
+            case STATE_LIST: {
+                if (index >= _block->live) {
+                    return nullptr;
+                }
+                const _Slot *slots = _block->Slots();
+                if (_block->live == _block->count) {
+                    return slots + index;
+                }
+                if (index == _block->live - 1) {
+                    return slots + _block->count - 1; // 最后一个存储槽总是非空，刚追加的对象无需查找
+                }
+                for (size_t i = 0;; ++i) {
+                    if (!slots[i].IsEmpty() && index-- == 0) return slots + i;
+                }
+            }
+            default: {
+                return nullptr;
+            }
+        }
+    }
+
+    /**
+     * @brief 内部函数，按指定优先级添加一个存储槽中对象的副本，返回新对象的索引
+     * @param function 存储槽中对象包装的函数指针（见EmplaceFunction），没有时为nullptr
+     */
+    size_t _AddSlot(const _Slot &slot, bool deep, int priority, TFunction function = nullptr)
+    {
+        _Slot *dst;
+        if (_IsSingleAvailable()) {
+            dst = &_single;
+        } else {
+            dst = &_AppendSlot();
+        }
+        if (deep) {
+            dst->CloneFrom(slot, _resource);
+        } else {
+            dst->CopyFrom(slot);
+        }
+        if (dst == &_single) {
+            _single.priority = priority;
+            _function        = function;
+            _state           = STATE_SINGLE;
+            return 0;
+        }
+        return _IndexOf(_CommitSlot(priority));
+    }
+
+    /**
+     * @brief 内部函数，判断新对象是否可以直接存储在_single中
+     */
+    bool _IsSingleAvailable() const noexcept
+    {
+        return _state == STATE_NONE && _block == nullptr && _single.IsEmpty();
+    }
+
+    /**
+     * @brief 内部函数，移除所有满足条件的对象，pred接受const _Slot &
+     * @note  找到第一个需要移除的对象后才确保内存块可直接修改，没有对象被移除时不会复制共享的内存块
+     */
+    template <typename TSlotPred>
+    size_t _RemoveIf(TSlotPred &&pred)
+    {
+        switch (_state) {
+            case STATE_SINGLE: {
+                if (!pred(_single)) {
+                    return 0;
+                }
+                _Reset();
+                return 1;
+            }
+            case STATE_LIST: {
+                const _Slot *slots = _block->Slots();
+                size_t pos         = 0;
+                size_t kept        = 0; // 第一个需要移除的对象之前的存活对象数量
+                for (; pos < _block->count; ++pos) {
+                    if (slots[pos].IsEmpty()) continue;
+                    if (pred(slots[pos])) break;
+                    ++kept;
+                }
+                if (pos == _block->count) {
+                    return 0;
+                }
+                if (_block->live == 1) {
+                    _Reset();
+                    return 1;
+                }
+                _Block *block = _block;
+                _MakeBlockWritable(0);
+                if (_block != block) {
+                    pos = kept; // 复制得到的内存块中存活对象紧密排列
+                }
+                size_t removed = 1;
+                _EraseSlot(pos);
+                try {
+                    for (size_t i = pos + 1; i < _block->count; ++i) {
+                        if (!_block->Slots()[i].IsEmpty() && pred(_block->Slots()[i])) {
+                            _EraseSlot(i);
+                            ++removed;
+                        }
+                    }
+                } catch (...) {
+                    _TrimBlock();
+                    throw;
+                }
+                _TrimBlock();
+                return removed;
+            }
+            default: {
+                return 0;
+            }
+        }
+    }
+
+    /**
+     * @brief 内部函数，若调用期间报告过失效的对象则将其移除，空出的存储槽可被新对象使用
+     */
+    void _RemoveReportedExpired()
+    {
+        if (_state == STATE_LIST ? _block->expired.load(std::memory_order_relaxed)
+                                 : _state == STATE_SINGLE && _single.IsExpired()) {
+            RemoveExpired();
+        }
+    }
+
+    /**
+     * @brief 内部函数，在内存块末尾准备一个空的存储槽，调用者负责在填充后调用_CommitSlot
+     * @note  列表为空时只准备内存块，由_CommitSlot切换到STATE_LIST，填充存储槽时抛出异常则列表保持为空，
+     *        准备好的内存块作为预留空间保留
+     */
+    _Slot &_AppendSlot()
+    {
+        if (_state == STATE_NONE) {
+            if (_block == nullptr) _block = _AllocBlock(_resource, 4);
+        } else {
+            _MakeBlockWritable(1);
+        }
+        if (_block->count == _block->capacity) {
+            if (_block->live < _block->count) {
+                _CompactBlock(_block);
+            } else {
+                _Block *block = _RebuildBlock(_resource, _block, _block->capacity * 2, true);
+                _ReleaseBlock(_block);
+                _block = block;
+            }
+        }
+        if (_indexed && _block->index == nullptr && _block->live + 1 >= _INDEX_THRESHOLD) {
+            _AllocIndex(_block);
+            _RefillIndex(_block);
+        }
+        return *new (_block->Slots() + _block->count) _Slot();
+    }
+
+    /**
+     * @brief 内部函数，获取内存块中指定位置处的对象的索引，位置处的存储槽需非空
+     * @note  没有空槽或位于最后一个存储槽时无需查找
+     */
+    size_t _IndexOf(size_t pos) const noexcept
+    {
+        if (_block->live == _block->count) {
+            return pos;
+        }
+        if (pos == _block->count - 1) {
+            return _block->live - 1;
+        }
+        const _Slot *slots = _block->Slots();
+        size_t index       = pos;
+        for (size_t i = 0; i < pos; ++i) {
+            if (slots[i].IsEmpty()) --index;
+        }
+        return index;
+    }
+
+    /**
+     * @brief 内部函数，确认_AppendSlot返回的存储槽已被填充，并按优先级将其移动到合适的位置
+     * @return 新对象在内存块中的位置，可通过_IndexOf转换为索引
+     * @note   列表中的对象按优先级从高到低排列，空槽保留原有的优先级，因此可以直接在包含空槽的内存块上二分查找
+     */
+    size_t _CommitSlot(int priority) noexcept
+    {
+        _Slot *slots = _block->Slots();
+        size_t pos   = _block->count;
+
+        _state = STATE_LIST;
+
+        slots[pos].priority = priority;
+        ++_block->count;
+        ++_block->live;
+
+        if (pos == 0 || slots[pos - 1].priority >= priority) {
+            if (_block->index != nullptr) {
+                _IndexInsert(_block, slots[pos].Get()->GetHashCode(), pos);
+            }
+            return pos;
+        }
+
+        // 找到第一个优先级低于新对象的位置，将新对象轮换到该位置
+        size_t first = 0, last = pos;
+        while (first < last) {
+            size_t mid = first + (last - first) / 2;
+            if (slots[mid].priority >= priority) {
+                first = mid + 1;
+            } else {
+                last = mid;
+            }
+        }
+        _Slot temp;
+        temp.MoveFrom(slots[pos]);
+        for (size_t i = pos; i > first; --i) {
+            slots[i].MoveFrom(slots[i - 1]);
+        }
+        slots[first].MoveFrom(temp);
+        for (size_t i = first + 1; i <= pos; ++i) {
+            if (slots[i].handle != 0) _block->handles[slots[i].handle - 1].pos = static_cast<uint32_t>(i);
+        }
+        if (_block->index != nullptr) {
+            _RefillIndex(_block);
+        }
+        return first;
+    }
+
+    /**
+     * @brief 内部函数，确保列表使用可直接修改的内存块存储，调用者需保证列表不为空
+     * @param reserve 需要复制内存块时额外预留的空间
+     */
+    void _MakeBlockWritable(size_t reserve)
+    {
+        if (_state == STATE_SINGLE) {
+            // 正在调用的对象不能被移动，此时复制该对象并将原对象留到调用结束后销毁
+            size_t capacity = 4;
+            while (capacity < 1 + reserve) {
+                capacity *= 2;
+            }
+            _Block *block = _AllocBlock(_resource, capacity);
+            new (block->Slots()) _Slot();
+            _InvokeFrame *frame = _FindFrame();
+            if (frame == nullptr) {
+                block->Slots()[0].MoveFrom(_single);
+            } else {
+                try {
+                    block->Slots()[0].CopyFrom(_single);
+                } catch (...) {
+                    _FreeBlock(block);
+                    throw;
+                }
+                frame->stale = true;
+            }
+            block->count = 1;
+            block->live  = 1;
+            _block       = block;
+            _state       = STATE_LIST;
+        } else if (!_IsBlockWritable()) {
+            size_t capacity = _block->capacity;
+            while (capacity < _block->live + reserve) {
+                capacity *= 2;
+            }
+            _Block *block = _RebuildBlock(_resource, _block, capacity, false);
+            _DetachBlock();
+            _block = block;
+            _state = STATE_LIST;
+        }
+    }
+
+    /**
+     * @brief 内部函数，移除内存块中指定位置处的对象
+     */
+    void _RemoveSlot(size_t pos)
+    {
+        if (_block->live == 1) {
+            _Reset();
+            return;
+        }
+        if (!_IsBlockWritable()) {
+            // 内存块被共享或正在被遍历，复制时跳过被移除的对象
+            _Block *block = _RebuildBlock(_resource, _block, _block->capacity, false, pos);
+            _DetachBlock();
+            _block = block;
+            _state = STATE_LIST;
+            return;
+        }
+        _EraseSlot(pos);
+        _TrimBlock();
+    }
+
+    /**
+     * @brief 内部函数，清空可直接修改的内存块中指定位置处的存储槽，调用者需在之后调用_TrimBlock
+     */
+    void _EraseSlot(size_t pos) noexcept
+    {
+        _Slot *slots = _block->Slots();
+        if (_block->index != nullptr) {
+            _IndexErase(_block, slots[pos].Get()->GetHashCode(), pos);
+        }
+        if (slots[pos].handle != 0) {
+            _FreeHandle(_block, slots[pos].handle);
+            slots[pos].handle = 0;
+        }
+        slots[pos].Reset();
+        --_block->live;
+    }
+
+    /**
+     * @brief 内部函数，移除对象后整理内存块：销毁末尾的空槽，空槽过多时压缩内存块，没有对象时释放内存块
+     * @note  只剩一个对象时仍使用内存块存储，需要时可调用Compact将其移回列表内部
+     */
+    void _TrimBlock() noexcept
+    {
+        if (_block->live == 0) {
+            _Reset();
+            return;
+        }
+        _Slot *slots = _block->Slots();
+        while (slots[_block->count - 1].IsEmpty()) {
+            slots[--_block->count].~_Slot();
+        }
+        if (_block->count - _block->live > _block->live) {
+            _CompactBlock(_block);
+        }
+    }
+
+    /**
+     * @brief 内部函数，查找令牌对应的对象在内存块中的位置
+     * @return 如果令牌有效则返回对象的位置，否则返回SIZE_MAX
+     */
+    size_t _FindHandle(SubscriptionToken token) const noexcept
+    {
+        if (_state != STATE_LIST) {
+            return SIZE_MAX;
+        }
+        uint32_t handle = static_cast<uint32_t>(token.Value());
+        uint32_t serial = static_cast<uint32_t>(token.Value() >> 32);
+        if (handle == 0 || handle > _block->handleCount) {
+            return SIZE_MAX;
+        }
+        const _Handle &entry = _block->handles[handle - 1];
+        if (entry.serial != serial || entry.pos >= _block->count || _block->Slots()[entry.pos].handle != handle) {
+            return SIZE_MAX;
+        }
+        return entry.pos;
+    }
+
+    /**
+     * @brief  内部函数，查找内存块中最后一个与给定对象相等的对象，存在哈希索引时只比较哈希值相同的对象
+     * @return 如果找到则返回对象的位置，否则返回SIZE_MAX
+     */
+    size_t _FindLast(const TCallable &callable) const
+    {
+        const _Slot *slots = _block->Slots();
+        if (_block->index == nullptr) {
+            for (size_t i = _block->count; i > 0; --i) {
+                if (!slots[i - 1].IsEmpty() && slots[i - 1].Get()->Equals(callable)) return i - 1;
+            }
+            return SIZE_MAX;
+        }
+
+        const _IndexEntry *index = _block->index;
+        size_t mask              = _block->indexMask;
+        size_t hash              = callable.GetHashCode();
+        size_t result            = SIZE_MAX;
+        for (size_t i = _IndexHome(hash, mask); index[i].pos != SIZE_MAX; i = (i + 1) & mask) {
+            const _IndexEntry &entry = index[i];
+            if (entry.hash == hash && (result == SIZE_MAX || entry.pos > result) &&
+                slots[entry.pos].Get()->Equals(callable)) {
+                result = entry.pos;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief 内部函数，判断当前内存块是否可以直接修改（未被共享且未被遍历）
+     */
+    bool _IsBlockWritable() const noexcept
+    {
+        if (_block->refs.load(std::memory_order_acquire) != 1) {
+            return false;
+        }
+        for (auto frame = _TopFrame(); frame != nullptr; frame = frame->prev) {
+            if (frame->list == this && frame->block == _block) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 内部函数，释放对当前内存块的引用，若当前线程上的调用帧正在遍历该内存块，则将引用转移给最外层的调用帧
+     */
+    void _DetachBlock() noexcept
+    {
+        _InvokeFrame *owner = nullptr;
+        bool owned          = false;
+        for (auto frame = _TopFrame(); frame != nullptr; frame = frame->prev) {
+            if (frame->list == this && frame->block == _block) {
+                owner = frame;
+                owned = owned || frame->ownsBlock;
+            }
+        }
+        if (owner != nullptr && !owned) {
+            owner->ownsBlock = true;
+        } else {
+            _ReleaseBlock(_block);
+        }
+        _block = nullptr;
+        _state = STATE_NONE;
+    }
+
+    /**
+     * @brief 内部函数，分配一个空的内存块
+     */
+    static _Block *_AllocBlock(_Resource *resource, size_t capacity)
+    {
+        void *memory  = _Allocate(resource, sizeof(_Block) + capacity * sizeof(_Slot));
+        _Block *block = new (memory) _Block;
+        block->refs.store(1, std::memory_order_relaxed);
+        block->resource       = resource;
+        block->count          = 0;
+        block->live           = 0;
+        block->capacity       = capacity;
+        block->index          = nullptr;
+        block->indexMask      = 0;
+        block->handles        = nullptr;
+        block->handleCount    = 0;
+        block->handleCapacity = 0;
+        block->freeHandle     = 0;
+        block->expired.store(false, std::memory_order_relaxed);
+        return block;
+    }
+
+    /**
+     * @brief 内部函数，将内存块中的对象复制或移动到一个新的内存块并去除空槽，可指定跳过一个位置处的对象
+     * @note  令牌表随对象一起复制或移动，已发放的令牌在新内存块中仍然有效
+     */
+    static _Block *_RebuildBlock(_Resource *resource, _Block *block, size_t capacity, bool move, size_t skip = SIZE_MAX)
+    {
+        _Block *result = _AllocBlock(resource, capacity);
+        try {
+            if (block->index != nullptr) {
+                _AllocIndex(result);
+            }
+            if (move && block->resource == resource) {
+                result->handles = block->handles;
+                block->handles  = nullptr;
+            } else if (block->handles != nullptr) {
+                result->handles = static_cast<_Handle *>(_Allocate(resource, block->handleCapacity * sizeof(_Handle)));
+                memcpy(result->handles, block->handles, block->handleCount * sizeof(_Handle));
+            }
+            result->handleCount    = block->handleCount;
+            result->handleCapacity = block->handleCapacity;
+            result->freeHandle     = block->freeHandle;
+
+            _Slot *slots = block->Slots();
+            for (size_t i = 0; i < block->count; ++i) {
+                if (slots[i].IsEmpty()) {
+                    continue;
+                }
+                if (i == skip) {
+                    if (slots[i].handle != 0) _FreeHandle(result, slots[i].handle);
+                    continue;
+                }
+                _Slot *dst = new (result->Slots() + result->count) _Slot();
+                if (move) {
+                    dst->MoveFrom(slots[i]);
+                } else {
+                    dst->CopyFrom(slots[i]);
+                    dst->handle = slots[i].handle;
+                }
+                if (dst->handle != 0) {
+                    result->handles[dst->handle - 1].pos = static_cast<uint32_t>(result->count);
+                }
+                ++result->count;
+                ++result->live;
+            }
+            if (result->index != nullptr) {
+                _RefillIndex(result);
+            }
+        } catch (...) {
+            _FreeBlock(result);
+            throw;
+        }
+        return result;
+    }
+
+    /**
+     * @brief 内部函数，原地去除内存块中的空槽，调用者需保证内存块可直接修改
+     */
+    static void _CompactBlock(_Block *block) noexcept
+    {
+        _Slot *slots = block->Slots();
+        size_t count = 0;
+        for (size_t i = 0; i < block->count; ++i) {
+            if (slots[i].IsEmpty()) {
+                continue;
+            }
+            if (i != count) {
+                slots[count].MoveFrom(slots[i]);
+                if (slots[count].handle != 0) {
+                    block->handles[slots[count].handle - 1].pos = static_cast<uint32_t>(count);
+                }
+            }
+            ++count;
+        }
+        for (size_t i = count; i < block->count; ++i) {
+            slots[i].~_Slot();
+        }
+        block->count = count;
+        if (block->index != nullptr) {
+            _RefillIndex(block);
+        }
+    }
+
+    /**
+     * @brief 内部函数，为内存块分配空的哈希索引，容量至少为内存块容量的两倍，因此插入时无需扩容
+     */
+    static void _AllocIndex(_Block *block)
+    {
+        size_t capacity = 32;
+        while (capacity < block->capacity * 2) {
+            capacity *= 2;
+        }
+        auto index = static_cast<_IndexEntry *>(_Allocate(block->resource, capacity * sizeof(_IndexEntry)));
+        _Deallocate(block->resource, block->index, (block->indexMask + 1) * sizeof(_IndexEntry));
+        block->index     = index;
+        block->indexMask = capacity - 1;
+        for (size_t i = 0; i < capacity; ++i) {
+            index[i].pos = SIZE_MAX;
+        }
+    }
+
+    /**
+     * @brief 内部函数，根据内存块中的对象重新填充哈希索引
+     */
+    static void _RefillIndex(_Block *block) noexcept
+    {
+        for (size_t i = 0; i <= block->indexMask; ++i) {
+            block->index[i].pos = SIZE_MAX;
+        }
+        _Slot *slots = block->Slots();
+        for (size_t i = 0; i < block->count; ++i) {
+            if (!slots[i].IsEmpty()) _IndexInsert(block, slots[i].Get()->GetHashCode(), i);
+        }
+    }
+
+    /**
+     * @brief 内部函数，计算哈希值在索引中的起始位置
+     */
+    static size_t _IndexHome(size_t hash, size_t mask) noexcept
+    {
+        hash *= static_cast<size_t>(0x9E3779B97F4A7C15ull);
+        return (hash ^ (hash >> (sizeof(size_t) * 4))) & mask;
+    }
+
+    /**
+     * @brief 内部函数，向哈希索引中插入一个条目
+     */
+    static void _IndexInsert(_Block *block, size_t hash, size_t pos) noexcept
+    {
+        size_t mask = block->indexMask;
+        size_t i    = _IndexHome(hash, mask);
+        while (block->index[i].pos != SIZE_MAX) {
+            i = (i + 1) & mask;
+        }
+        block->index[i].hash = hash;
+        block->index[i].pos  = pos;
+    }
+
+    /**
+     * @brief 内部函数，从哈希索引中删除一个条目，并将后续条目前移以填补空位
+     */
+    static void _IndexErase(_Block *block, size_t hash, size_t pos) noexcept
+    {
+        _IndexEntry *index = block->index;
+        size_t mask        = block->indexMask;
+        size_t i           = _IndexHome(hash, mask);
+        while (index[i].pos != pos) {
+            i = (i + 1) & mask;
+        }
+        for (size_t j = (i + 1) & mask; index[j].pos != SIZE_MAX; j = (j + 1) & mask) {
+            size_t home = _IndexHome(index[j].hash, mask);
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                index[i] = index[j];
+                i        = j;
+            }
+        }
+        index[i].pos = SIZE_MAX;
+    }
+
+    /**
+     * @brief 内部函数，为内存块中指定位置处的对象分配一个句柄
+     */
+    static uint32_t _AllocHandle(_Block *block, size_t pos)
+    {
+        uint32_t handle = block->freeHandle;
+        if (handle != 0) {
+            block->freeHandle = block->handles[handle - 1].pos;
+        } else {
+            if (block->handleCount == block->handleCapacity) {
+                uint32_t capacity = block->handleCapacity == 0 ? 4 : block->handleCapacity * 2;
+                auto handles      = static_cast<_Handle *>(_Allocate(block->resource, capacity * sizeof(_Handle)));
+                if (block->handleCount != 0) {
+                    memcpy(handles, block->handles, block->handleCount * sizeof(_Handle));
+                }
+                _Deallocate(block->resource, block->handles, block->handleCapacity * sizeof(_Handle));
+                block->handles        = handles;
+                block->handleCapacity = capacity;
+            }
+            handle = ++block->handleCount;
+        }
+        block->handles[handle - 1].pos    = static_cast<uint32_t>(pos);
+        block->handles[handle - 1].serial = _NextSerial();
+        return handle;
+    }
+
+    /**
+     * @brief 内部函数，获取下一个全局唯一的句柄序号，跳过0
+     */
+    static uint32_t _NextSerial() noexcept
+    {
+        static std::atomic<uint32_t> next(0);
+        uint32_t serial;
+        do {
+            serial = next.fetch_add(1, std::memory_order_relaxed) + 1;
+        } while (serial == 0);
+        return serial;
+    }
+
+    /**
+     * @brief 内部函数，释放一个句柄，之前发放的令牌随之失效
+     */
+    static void _FreeHandle(_Block *block, uint32_t handle) noexcept
+    {
+        _Handle &entry = block->handles[handle - 1];
+        entry.serial      = 0;
+        entry.pos         = block->freeHandle;
+        block->freeHandle = handle;
+    }
+
+    /**
+     * @brief 内部函数，销毁内存块中的对象并释放内存
+     */
+    static void _FreeBlock(_Block *block) noexcept
+    {
+        for (size_t i = block->count; i > 0; --i) {
+            block->Slots()[i - 1].~_Slot();
+        }
+        _Resource *resource = block->resource;
+        if (block->index != nullptr) {
+            _Deallocate(resource, block->index, (block->indexMask + 1) * sizeof(_IndexEntry));
+        }
+        _Deallocate(resource, block->handles, block->handleCapacity * sizeof(_Handle));
+        size_t size = sizeof(_Block) + block->capacity * sizeof(_Slot);
+        block->~_Block();
+        _Deallocate(resource, block, size);
+    }
+
+    /**
+     * @brief 内部函数，减少内存块的引用计数，计数为0时释放内存块
+     */
+    static void _ReleaseBlock(_Block *block) noexcept
+    {
+        if (block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            _FreeBlock(block);
+        }
+    }
+
+    /**
+     * @brief 重置当前状态，释放存储的可调用对象
+     */
+    void _Reset() noexcept
+    {
+        switch (_state) {
+            case STATE_NONE: {
+                // 释放预留的内存块
+                if (_block != nullptr) {
+                    _FreeBlock(_block);
+                    _block = nullptr;
+                }
+                break;
+            }
+            case STATE_SINGLE: {
+                // 正在调用的对象在调用结束后销毁
+                _InvokeFrame *frame = _FindFrame();
+                if (frame == nullptr) {
+                    _single.Reset();
+                } else {
+                    frame->stale = true;
+                }
+                _block = nullptr;
+                _state = STATE_NONE;
+                break;
+            }
+            case STATE_LIST: {
+                _DetachBlock();
+                break;
+            }
+        }
+    }
+};
+
+/*================================================================================*/
+
+/**
+ * @brief 委托类，类似于C#中的委托，支持存储和调用任意可调用对象
+ */
+template <typename TRet, typename... Args>
+class Delegate<TRet(Args...)> final : public ICallable<TRet(Args...)>
+{
+private:
+    // StaticDelegate与Delegate使用相同的可调用对象包装类
+    template <typename, size_t>
+    friend class StaticDelegate;
+
+    // 存储槽通过InvokeWith调用嵌套的委托
+    friend class CallableList<TRet(Args...)>;
+
+    // DeferredDelegate直接使用保存的参数调用委托
+    friend class DeferredDelegate<TRet(Args...)>;
+
+    using _ICallable = ICallable<TRet(Args...)>;
+    using _List      = CallableList<TRet(Args...)>;
+
+    template <typename T>
+    using _ArgRef = typename _List::template TArgRef<T>;
+
+    template <typename T, typename = void>
+    struct _IsEqualityComparable : std::false_type {
+    };
+
+    template <typename T>
+    struct _IsEqualityComparable<
+        T, decltype(void(std::declval<T>() == std::declval<T>()))> : std::true_type {
+    };
+
+    template <typename T, typename = void>
+    struct _IsConstInvocable : std::false_type {
+    };
+
+    template <typename T>
+    struct _IsConstInvocable<
+        T, decltype(void(std::declval<const T &>()(std::declval<Args>()...)))> : std::true_type {
+    };
+
+    template <typename T, typename = void>
+    struct _IsMemcmpSafe : std::false_type {
+    };
+
+    template <typename T>
+    struct _IsMemcmpSafe<
+        T,
+        typename std::enable_if</*std::is_trivial<T>::value &&*/ std::is_standard_layout<T>::value, void>::type> : std::true_type {
+    };
+
+    /**
+     * @brief 计算一段内存的哈希值（FNV-1a）
+     */
+    static size_t _HashBytes(const void *data, size_t size) noexcept
+    {
+        auto bytes  = static_cast<const uint8_t *>(data);
+        size_t hash = static_cast<size_t>(14695981039346656037ull);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * static_cast<size_t>(1099511628211ull);
+        }
+        return hash;
+    }
+
+    /**
+     * @brief 组合两个哈希值
+     */
+    static size_t _HashCombine(size_t a, size_t b) noexcept
+    {
+        return a ^ (b + static_cast<size_t>(0x9E3779B97F4A7C15ull) + (a << 6) + (a >> 2));
+    }
+
+    /**
+     * @brief 标记在包装对象内部直接构造可调用对象的构造函数
+     */
+    struct _InPlaceTag {
+    };
+
+    template <typename T>
+    class _CallableWrapperImpl final : public _ICallable
+    {
+        alignas(T) mutable uint8_t _storage[sizeof(T)];
+
+    public:
+        // 包装对象本身总是声明了拷贝构造函数，需单独声明所包装对象是否可以复制
+        static constexpr bool IsCopyable = std::is_copy_constructible<T>::value;
+
+        // 只能通过非const调用运算符调用的对象（如mutable lambda）可能在调用时修改自身状态
+        static constexpr bool HasMutableState = !_IsConstInvocable<T>::value;
+
+        _CallableWrapperImpl(const T &value)
+        {
+            memset(_storage, 0, sizeof(_storage));
+            new (_storage) T(value);
+        }
+        _CallableWrapperImpl(T &&value)
+        {
+            memset(_storage, 0, sizeof(_storage));
+            new (_storage) T(std::move(value));
+        }
+        template <typename... CtorArgs>
+        explicit _CallableWrapperImpl(_InPlaceTag, CtorArgs &&...args)
+        {
+            memset(_storage, 0, sizeof(_storage));
+            new (_storage) T(std::forward<CtorArgs>(args)...);
+        }
+        _CallableWrapperImpl(const _CallableWrapperImpl &other)
+            : _CallableWrapperImpl(other.GetValue())
+        {
+        }
+        _CallableWrapperImpl(_CallableWrapperImpl &&other) noexcept(std::is_nothrow_move_constructible<T>::value)
+            : _CallableWrapperImpl(std::move(other.GetValue()))
+        {
+        }
+        virtual ~_CallableWrapperImpl()
+        {
+            GetValue().~T();
+            // memset(_storage, 0, sizeof(_storage));
+        }
+        T &GetValue() const noexcept
+        {
+            return *reinterpret_cast<T *>(_storage);
+        }
+        TRet Invoke(Args... args) const override
+        {
+            return GetValue()(std::forward<Args>(args)...);
+        }
+        TRet InvokeWith(bool forward, _ArgRef<Args>... args) const
+        {
+            if (forward) return _List::InvokeForward(GetValue(), args...);
+            return _List::InvokeShared(GetValue(), args...);
+        }
+        _ICallable *Clone() const override
+        {
+            return CloneImpl();
+        }
+        virtual TypeId GetType() const override
+        {
+            return TypeId::Of<T>();
+        }
+        template <typename U = T>
+        typename std::enable_if<std::is_copy_constructible<U>::value, _ICallable *>::type
+        CloneImpl() const
+        {
+            return new _CallableWrapperImpl(GetValue());
+        }
+        template <typename U = T>
+        typename std::enable_if<!std::is_copy_constructible<U>::value, _ICallable *>::type
+        CloneImpl() const
+        {
+            throw std::runtime_error("Callable is not copyable");
+        }
+        bool Equals(const _ICallable &other) const override
+        {
+            return EqualsImpl(other);
+        }
+        size_t GetHashCode() const noexcept override
+        {
+            return HashImpl();
+        }
+        template <typename U = T>
+        typename std::enable_if<_IsEqualityComparable<U>::value, bool>::type
+        EqualsImpl(const _ICallable &other) const
+        {
+            if (this == &other) {
+                return true;
+            }
+            if (GetType() != other.GetType()) {
+                return false;
+            }
+            const auto &otherWrapper = static_cast<const _CallableWrapperImpl &>(other);
+            return GetValue() == otherWrapper.GetValue();
+        }
+        template <typename U = T>
+        typename std::enable_if<!_IsEqualityComparable<U>::value && _IsMemcmpSafe<U>::value, bool>::type
+        EqualsImpl(const _ICallable &other) const
+        {
+            if (this == &other) {
+                return true;
+            }
+            if (GetType() != other.GetType()) {
+                return false;
+            }
+            const auto &otherWrapper = static_cast<const _CallableWrapperImpl &>(other);
+            return memcmp(_storage, otherWrapper._storage, sizeof(_storage)) == 0;
+        }
+        template <typename U = T>
+        typename std::enable_if<!_IsEqualityComparable<U>::value && !_IsMemcmpSafe<U>::value, bool>::type
+        EqualsImpl(const _ICallable &other) const
+        {
+            return this == &other;
+        }
+        template <typename U = T>
+        typename std::enable_if<std::is_scalar<U>::value, size_t>::type
+        HashImpl() const noexcept
+        {
+            return _HashBytes(_storage, sizeof(_storage));
+        }
+        template <typename U = T>
+        typename std::enable_if<!std::is_scalar<U>::value && !_IsEqualityComparable<U>::value && _IsMemcmpSafe<U>::value, size_t>::type
+        HashImpl() const noexcept
+        {
+            return _HashCombine(GetType().hash_code(), _HashBytes(_storage, sizeof(_storage)));
+        }
+        template <typename U = T>
+        typename std::enable_if<!std::is_scalar<U>::value && (_IsEqualityComparable<U>::value || !_IsMemcmpSafe<U>::value), size_t>::type
+        HashImpl() const noexcept
+        {
+            return GetType().hash_code();
+        }
+    };
+
+    template <typename T>
+    using _CallableWrapper = _CallableWrapperImpl<typename std::decay<T>::type>;
+
+    /**
+     * @brief 成员函数包装的公共基类，以(对象, 成员函数)作为标识
+     * @note  运行时传入成员函数指针的包装与编译期绑定的包装共用此标识，二者可以互相匹配
+     */
+    template <typename TMethod>
+    class _MemberFuncCallable : public _ICallable
+    {
+    public:
+        virtual const void *GetTarget() const noexcept = 0;
+        virtual TMethod GetMethod() const noexcept     = 0;
+        virtual TypeId GetType() const override
+        {
+            return TypeId::Of<TMethod>();
+        }
+        bool Equals(const _ICallable &other) const override
+        {
+            if (this == &other) {
+                return true;
+            }
+            if (GetType() != other.GetType()) {
+                return false;
+            }
+            const auto &otherCallable = static_cast<const _MemberFuncCallable &>(other);
+            return GetTarget() == otherCallable.GetTarget() && GetMethod() == otherCallable.GetMethod();
+        }
+        size_t GetHashCode() const noexcept override
+        {
+            const void *obj = GetTarget();
+            TMethod func    = GetMethod();
+            return _HashCombine(_HashBytes(&obj, sizeof(obj)), _HashBytes(&func, sizeof(func)));
+        }
+    };
+
+    template <typename T>
+    class _MemberFuncWrapper final : public _MemberFuncCallable<TRet (T::*)(Args...)>
+    {
+        T *obj;
+        TRet (T::*func)(Args...);
+
+    public:
+        _MemberFuncWrapper(T &obj, TRet (T::*func)(Args...))
+            : obj(&obj), func(func)
+        {
+        }
+        TRet Invoke(Args... args) const override
+        {
+            return (obj->*func)(std::forward<Args>(args)...);
+        }
+        TRet InvokeWith(bool forward, _ArgRef<Args>... args) const
+        {
+            if (forward) return (obj->*func)(static_cast<Args &&>(args)...);
+            return (obj->*func)(_List::template CopyArg<Args>(args)...);
+        }
+        const void *GetTarget() const noexcept override
+        {
+            return obj;
+        }
+        decltype(func) GetMethod() const noexcept override
+        {
+            return func;
+        }
+        _ICallable *Clone() const override
+        {
+            return new _MemberFuncWrapper(*obj, func);
+        }
+    };
+
+    template <typename T>
+    class _ConstMemberFuncWrapper final : public _MemberFuncCallable<TRet (T::*)(Args...) const>
+    {
+        const T *obj;
+        TRet (T::*func)(Args...) const;
+
+    public:
+        _ConstMemberFuncWrapper(const T &obj, TRet (T::*func)(Args...) const)
+            : obj(&obj), func(func)
+        {
+        }
+        TRet Invoke(Args... args) const override
+        {
+            return (obj->*func)(std::forward<Args>(args)...);
+        }
+        TRet InvokeWith(bool forward, _ArgRef<Args>... args) const
+        {
+            if (forward) return (obj->*func)(static_cast<Args &&>(args)...);
+            return (obj->*func)(_List::template CopyArg<Args>(args)...);
+        }
+        const void *GetTarget() const noexcept override
+        {
+            return obj;
+        }
+        decltype(func) GetMethod() const noexcept override
+        {
+            return func;
+        }
+        _ICallable *Clone() const override
+        {
+            return new _ConstMemberFuncWrapper(*obj, func);
+        }
+    };
+
+    /**
+     * @brief 编译期绑定的成员函数对应的运行时成员函数指针类型
+     * @note  若成员函数可以转换为TRet (T::*)(Args...)（常量成员函数对应const版本），则使用该类型，
+     *        使Remove(obj, &T::Method)等运行时重载能够匹配编译期绑定的对象；否则使用成员函数本身的类型
+     */
+    template <typename T, typename TFunc>
+    struct _BoundMethodType {
+        using runtime = typename std::conditional<std::is_const<T>::value,
+                                                  TRet (std::remove_const<T>::type::*)(Args...) const,
+                                                  TRet (std::remove_const<T>::type::*)(Args...)>::type;
+        using type    = typename std::conditional<std::is_convertible<TFunc, runtime>::value, runtime, TFunc>::type;
+    };
+
+    /**
+     * @brief 编译期绑定的成员函数包装，只存储对象指针，成员函数在调用处可被内联展开
+     * @note  T为const类型时表示常量成员函数
+     */
+    template <typename T, typename TFunc, TFunc func>
+    class _BoundMemberFuncWrapper final : public _MemberFuncCallable<typename _BoundMethodType<T, TFunc>::type>
+    {
+        using _Method = typename _BoundMethodType<T, TFunc>::type;
+
+        T *obj;
+
+    public:
+        explicit _BoundMemberFuncWrapper(T &obj)
+            : obj(&obj)
+        {
+        }
+        TRet Invoke(Args... args) const override
+        {
+            return (obj->*func)(std::forward<Args>(args)...);
+        }
+        TRet InvokeWith(bool forward, _ArgRef<Args>... args) const
+        {
+            if (forward) return (obj->*func)(static_cast<Args &&>(args)...);
+            return (obj->*func)(_List::template CopyArg<Args>(args)...);
+        }
+        const void *GetTarget() const noexcept override
+        {
+            return obj;
+        }
+        _Method GetMethod() const noexcept override
+        {
+            return func;
+        }
+        _ICallable *Clone() const override
+        {
+            return new _BoundMemberFuncWrapper(*obj);
+        }
+    };
+
+#if defined(DELEGATE_HAS_AUTO_TEMPLATE_PARAMETER)
+    /**
+     * @brief 获取成员函数指针所属的对象类型，常量成员函数对应const类型
+     */
+    template <typename TFunc>
+    struct _MemberFuncOwner;
+
+    template <typename T, typename R, typename... P>
+    struct _MemberFuncOwner<R (T::*)(P...)> {
+        using type = T;
+    };
+
+    template <typename T, typename R, typename... P>
+    struct _MemberFuncOwner<R (T::*)(P...) const> {
+        using type = const T;
+    };
+
+#if defined(__cpp_noexcept_function_type)
+    template <typename T, typename R, typename... P>
+    struct _MemberFuncOwner<R (T::*)(P...) noexcept> {
+        using type = T;
+    };
+
+    template <typename T, typename R, typename... P>
+    struct _MemberFuncOwner<R (T::*)(P...) const noexcept> {
+        using type = const T;
+    };
+#endif
+
+    /**
+     * @brief Method对应的编译期绑定包装类型
+     */
+    template <auto Method>
+    using _BoundWrapperOf = _BoundMemberFuncWrapper<typename _MemberFuncOwner<decltype(Method)>::type, decltype(Method), Method>;
+#endif
+
+    /**
+     * @brief 弱订阅的成员函数包装，对象析构后不再调用成员函数
+     */
+    template <typename T>
+    class _WeakMemberFuncWrapper final : public _ICallable
+    {
+        Trackable::WeakHandle handle;
+        TRet (T::*func)(Args...);
+
+    public:
+        _WeakMemberFuncWrapper(T &obj, TRet (T::*func)(Args...))
+            : handle(obj.GetWeakHandle()), func(func)
+        {
+        }
+        TRet Invoke(Args... args) const override
+        {
+            Trackable *owner = handle.Get();
+            if (owner == nullptr) return _OnExpired();
+            return (static_cast<T *>(owner)->*func)(std::forward<Args>(args)...);
+        }
+        TRet InvokeWith(bool forward, _ArgRef<Args>... args) const
+        {
+            Trackable *owner = handle.Get();
+            if (owner == nullptr) return _OnExpired();
+            if (forward) return (static_cast<T *>(owner)->*func)(static_cast<Args &&>(args)...);
+            return (static_cast<T *>(owner)->*func)(_List::template CopyArg<Args>(args)...);
+        }
+        bool IsExpired() const noexcept
+        {
+            return !handle.IsAlive();
+        }
+        const void *GetTarget() const noexcept
+        {
+            Trackable *owner = handle.Get();
+            return owner == nullptr ? nullptr : static_cast<T *>(owner);
+        }
+        _ICallable *Clone() const override
+        {
+            return new _WeakMemberFuncWrapper(*this);
+        }
+        virtual TypeId GetType() const override
+        {
+            return TypeId::Of<_WeakMemberFuncWrapper>();
+        }
+        bool Equals(const _ICallable &other) const override
+        {
+            if (this == &other) {
+                return true;
+            }
+            if (GetType() != other.GetType()) {
+                return false;
+            }
+            const auto &otherWrapper = static_cast<const _WeakMemberFuncWrapper &>(other);
+            return handle == otherWrapper.handle && func == otherWrapper.func;
+        }
+        size_t GetHashCode() const noexcept override
+        {
+            return _HashCombine(handle.GetHashCode(), _HashBytes(&func, sizeof(func)));
+        }
+    };
+
+    /**
+     * @brief 弱订阅的常量成员函数包装，对象析构后不再调用成员函数
+     */
+    template <typename T>
+    class _WeakConstMemberFuncWrapper final : public _ICallable
+    {
+        Trackable::WeakHandle handle;
+        TRet (T::*func)(Args...) const;
+
+    public:
+        _WeakConstMemberFuncWrapper(const T &obj, TRet (T::*func)(Args...) const)
+            : handle(obj.GetWeakHandle()), func(func)
+        {
+        }
+        TRet Invoke(Args... args) const override
+        {
+            const Trackable *owner = handle.Get();
+            if (owner == nullptr) return _OnExpired();
+            return (static_cast<const T *>(owner)->*func)(std::forward<Args>(args)...);
+        }
+        TRet InvokeWith(bool forward, _ArgRef<Args>... args) const
+        {
+            const Trackable *owner = handle.Get();
+            if (owner == nullptr) return _OnExpired();
+            if (forward) return (static_cast<const T *>(owner)->*func)(static_cast<Args &&>(args)...);
+            return (static_cast<const T *>(owner)->*func)(_List::template CopyArg<Args>(args)...);
+        }
+        bool IsExpired() const noexcept
+        {
+            return !handle.IsAlive();
+        }
+        const void *GetTarget() const noexcept
+        {
+            const Trackable *owner = handle.Get();
+            return owner == nullptr ? nullptr : static_cast<const T *>(owner);
+        }
+        _ICallable *Clone() const override
+        {
+            return new _WeakConstMemberFuncWrapper(*this);
+        }
+        virtual TypeId GetType() const override
+        {
+            return TypeId::Of<_WeakConstMemberFuncWrapper>();
+        }
+        bool Equals(const _ICallable &other) const override
+        {
+            if (this == &other) {
+                return true;
+            }
+            if (GetType() != other.GetType()) {
+                return false;
+            }
+            const auto &otherWrapper = static_cast<const _WeakConstMemberFuncWrapper &>(other);
+            return handle == otherWrapper.handle && func == otherWrapper.func;
+        }
+        size_t GetHashCode() const noexcept override
+        {
+            return _HashCombine(handle.GetHashCode(), _HashBytes(&func, sizeof(func)));
+        }
+    };
+
+    /**
+     * @brief 弱订阅的对象已析构时调用，返回默认值
+     * @note  调用该对象的InvokeScope会在调用结束后发现其已失效并标记正在遍历的内存块
+     */
+    static TRet _OnExpired()
+    {
+        return TRet();
+    }
+
+    /**
+     * @brief 延迟调用中保存的参数类型，非常量左值引用参数保存引用，其余参数（包括常量引用参数）保存副本
+     */
+    template <typename T>
+    using _StoredArg = typename std::conditional<std::is_lvalue_reference<T>::value &&
+                                                     !std::is_const<typename std::remove_reference<T>::type>::value,
+                                                 T, typename std::decay<T>::type>::type;
+
+    /**
+     * @brief 一次异步调用的状态，定义见类外
+     */
+    struct _AsyncCall;
+
+#if defined(DELEGATE_HAS_COROUTINE)
+    /**
+     * @brief InvokeAwaitable返回的可以co_await的对象，定义见类外
+     */
+    template <typename TExecutor>
+    class _InvokeAwaiter;
+#endif
+
+private:
+    /**
+     * @brief 内部存储可调用对象的容器
+     */
+    CallableList<TRet(Args...)> _data;
+
+public:
+    /**
+     * @brief 默认构造函数
+     */
+    Delegate(std::nullptr_t = nullptr)
+    {
+    }
+
+#if defined(DELEGATE_HAS_MEMORY_RESOURCE)
+    /**
+     * @brief 构造函数，指定分配内存使用的内存资源
+     * @note  存储可调用对象的内存块和堆对象均从该资源分配，复制得到的委托使用相同的资源；
+     *        通过ICallable::Clone添加的自定义可调用对象本身仍由其Clone实现分配
+     */
+    template <typename TResource, typename std::enable_if<std::is_convertible<TResource *, std::pmr::memory_resource *>::value, int>::type = 0>
+    explicit Delegate(TResource *resource) noexcept
+        : _data(resource)
+    {
+    }
+#endif
+
+    /**
+     * @brief 构造函数，接受一个可调用对象
+     */
+    Delegate(const ICallable<TRet(Args...)> &callable)
+    {
+        Add(callable);
+    }
+
+    /**
+     * @brief 构造函数，接受一个函数指针
+     */
+    Delegate(TRet (*func)(Args...))
+    {
+        Add(func);
+    }
+
+    /**
+     * @brief 构造函数，接受一个可调用对象
+     */
+    template <typename T, typename std::enable_if<!std::is_base_of<_ICallable, T>::value, int>::type = 0>
+    Delegate(const T &callable)
+    {
+        Add(callable);
+    }
+
+    /**
+     * @brief 构造函数，接受一个右值可调用对象，该对象将被移动到委托中
+     */
+    template <typename T, typename std::enable_if<!std::is_reference<T>::value && !std::is_base_of<_ICallable, T>::value, int>::type = 0>
+    Delegate(T &&callable)
+    {
+        Add(std::move(callable));
+    }
+
+    /**
+     * @brief 构造函数，接受一个成员函数指针
+     */
+    template <typename T>
+    Delegate(T &obj, TRet (T::*func)(Args...))
+    {
+        Add(obj, func);
+    }
+
+    /**
+     * @brief 构造函数，接受一个常量成员函数指针
+     */
+    template <typename T>
+    Delegate(const T &obj, TRet (T::*func)(Args...) const)
+    {
+        Add(obj, func);
+    }
+
+    /**
+     * @brief 拷贝构造函数
+     * @note  复制的代价为O(1)且不产生堆分配。新委托与原委托总是共享存储的可调用对象：调用时可能修改自身状态的对象
+     *        （如mutable lambda）在两者之间只有一份，无论委托中有几个对象、对象大小如何，之后的添加和移除也不会使其分离；
+     *        其余对象不会因调用而改变，共享与复制没有区别。需要独立状态的副本时使用DeepClone
+     */
+    Delegate(const Delegate &other)
+        : _data(other._data)
+    {
+    }
+
+    /**
+     * @brief 移动构造函数
+     */
+    Delegate(Delegate &&other) noexcept
+        : _data(std::move(other._data))
+    {
+    }
+
+    /**
+     * @brief 拷贝赋值运算符
+     * @note  与拷贝构造函数相同，两个委托总是共享存储的可调用对象
+     */
+    Delegate &operator=(const Delegate &other)
+    {
+        if (this != &other) {
+            _data = other._data;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief 移动赋值运算符
+     */
+    Delegate &operator=(Delegate &&other) noexcept
+    {
+        if (this != &other) {
+            _data = std::move(other._data);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief          添加一个可调用对象到委托中
+     * @param priority 优先级，优先级高的对象先被调用，优先级相同的对象按添加顺序调用，默认为0
+     * @return         新对象在委托中的索引，若没有添加任何对象则返回SIZE_MAX
+     */
+    size_t Add(const ICallable<TRet(Args...)> &callable, int priority = 0)
+    {
+        // 当添加的可调用对象与当前委托类型相同时（针对单播委托进行优化）：
+        // - 若委托内容为空，则直接返回
+        // - 若委托内容只有一个元素，则克隆该元素并添加到当前委托中
+        // - 否则，添加该委托的副本，副本与原委托共享存储的可调用对象
+        // 其他类型的可调用对象通过Clone添加
+        if (callable.GetType() == GetType()) {
+            auto &delegate = static_cast<const Delegate &>(callable);
+            if (delegate._data.IsEmpty()) {
+                return SIZE_MAX;
+            } else if (delegate._data.Count() == 1) {
+                return _data.AddCopy(delegate._data, 0, priority);
+            } else {
+                return _data.template EmplaceWithPriority<Delegate>(priority, delegate);
+            }
+        }
+        return _data.Add(callable.Clone(), priority);
+    }
+
+    /**
+     * @brief          添加一个函数指针到委托中
+     * @param priority 优先级，优先级高的对象先被调用，优先级相同的对象按添加顺序调用，默认为0
+     * @return         新对象在委托中的索引，若func为nullptr则返回SIZE_MAX
+     */
+    size_t Add(TRet (*func)(Args...), int priority = 0)
+    {
+        if (func == nullptr) {
+            return SIZE_MAX;
+        }
+        return _data.template EmplaceFunction<_CallableWrapper<decltype(func)>>(priority, func);
+    }
+
+    /**
+     * @brief          添加一个可调用对象到委托中
+     * @param priority 优先级，优先级高的对象先被调用，优先级相同的对象按添加顺序调用，默认为0
+     * @return         新对象在委托中的索引
+     */
+    template <typename T>
+    typename std::enable_if<!std::is_base_of<_ICallable, T>::value, size_t>::type
+    Add(const T &callable, int priority = 0)
+    {
+        return _data.template EmplaceWithPriority<_CallableWrapper<T>>(priority, callable);
+    }
+
+    /**
+     * @brief          添加一个右值可调用对象到委托中，该对象将被移动到委托中，可用于只能移动的对象
+     * @param priority 优先级，优先级高的对象先被调用，优先级相同的对象按添加顺序调用，默认为0
+     * @return         新对象在委托中的索引
+     * @note           不可复制的对象在委托的副本之间共享，对包含这类对象的委托调用DeepClone将抛出异常
+     */
+    template <typename T>
+    typename std::enable_if<!std::is_reference<T>::value && !std::is_base_of<_ICallable, T>::value, size_t>::type
+    Add(T &&callable, int priority = 0)
+    {
+        return _data.template EmplaceWithPriority<_CallableWrapper<T>>(priority, std::move(callable));
+    }
+
+    /**
+     * @brief  在委托的存储中直接构造一个F类型的可调用对象，参数被转发给F的构造函数
+     * @return 新对象在委托中的索引
+     * @note   与Add相同，F可以是只能移动的类型
+     */
+    template <typename F, typename... CtorArgs>
+    size_t Emplace(CtorArgs &&...args)
+    {
+        return EmplaceWithPriority<F>(0, std::forward<CtorArgs>(args)...);
+    }
+
+    /**
+     * @brief          以指定的优先级在委托的存储中直接构造一个F类型的可调用对象，参数被转发给F的构造函数
+     * @param priority 优先级，优先级高的对象先被调用，优先级相同的对象按添加顺序调用
+     * @return         新对象在委托中的索引
+     */
+    template <typename F, typename... CtorArgs>
+    size_t EmplaceWithPriority(int priority, CtorArgs &&...args)
+    {
+        static_assert(std::is_same<F, typename std::decay<F>::type>::value, "F must be a non-reference, non-const type");
+        return _data.template EmplaceWithPriority<_CallableWrapperImpl<F>>(priority, _InPlaceTag(), std::forward<CtorArgs>(args)...);
+    }
+
+    /**
+     * @brief          添加一个成员函数指针到委托中
+     * @param priority 优先级，优先级高的对象先被调用，优先级相同的对象按添加顺序调用，默认为0
+     * @return         新对象在委托中的索引
+     */
+    template <typename T>
+    size_t Add(T &obj, TRet (T::*func)(Args...), int priority = 0)
+    {
+        return _data.template EmplaceWithPriority<_MemberFuncWrapper<T>>(priority, obj, func);
+    }
+
+    /**
+     * @brief          添加一个常量成员函数指针到委托中
+     * @param priority 优先级，优先级高的对象先被调用，优先级相同的对象按添加顺序调用，默认为0
+     * @return         新对象在委托中的索引
+     */
+    template <typename T>
+    size_t Add(const T &obj, TRet (T::*func)(Args...) const, int priority = 0)
+    {
+        return _data.template EmplaceWithPriority<_ConstMemberFuncWrapper<T>>(priority, obj, func);
+    }
+
+    /**
+     * @brief          添加一个在编译期绑定的成员函数到委托中，用法为Add<T, &T::Method>(obj)
+     * @param priority 优先级，优先级高的对象先被调用，优先级相同的对象按添加顺序调用，默认为0
+     * @return         新对象在委托中的索引
+     * @note           只存储对象指针，不会产生堆分配，成员函数在调用处可被内联展开；
+     *                 可通过Remove<T, &T::Method>(obj)或Remove(obj, &T::Method)移除
+     */
+    template <typename T, TRet (T::*Method)(Args...)>
+    size_t Add(T &obj, int priority = 0)
+    {
+        return _data.template EmplaceWithPriority<_BoundMemberFuncWrapper<T, decltype(Method), Method>>(priority, obj);
+    }
+
+    /**
+     * @brief          添加一个在编译期绑定的常量成员函数到委托中，用法为Add<T, &T::Method>(obj)
+     * @param priority 优先级，优先级高的对象先被调用，优先级相同的对象按添加顺序调用，默认为0
+     * @return         新对象在委托中的索引
+     * @note           只存储对象指针，不会产生堆分配，成员函数在调用处可被内联展开；
+     *                 可通过Remove<T, &T::Method>(obj)或Remove(obj, &T::Method)移除
+     */
+    template <typename T, TRet (T::*Method)(Args...) const>
+    size_t Add(const T &obj, int priority = 0)
+    {
+        return _data.template EmplaceWithPriority<_BoundMemberFuncWrapper<const T, decltype(Method), Method>>(priority, obj);
+    }
+
+#if defined(DELEGATE_HAS_AUTO_TEMPLATE_PARAMETER)
+    /**
+     * @brief          添加一个在编译期绑定的成员函数或常量成员函数到委托中，用法为Add<&T::Method>(obj)
+     * @param priority 优先级，优先级高的对象先被调用，优先级相同的对象按添加顺序调用，默认为0
+     * @return         新对象在委托中的索引
+     * @note           只存储对象指针，不会产生堆分配，成员函数在调用处可被内联展开；
+     *                 可通过Remove<&T::Method>(obj)或Remove(obj, &T::Method)移除。成员函数的签名不必与委托完全一致，
+     *                 只需可以用委托的参数调用，此时只能通过Remove<&T::Method>(obj)移除
+     */
+    template <auto Method>
+    size_t Add(typename _MemberFuncOwner<decltype(Method)>::type &obj, int priority = 0)
+    {
+        return _data.template EmplaceWithPriority<_BoundWrapperOf<Method>>(priority, obj);
+    }
+#endif
+
+    /**
+     * @brief          以弱订阅的形式添加一个成员函数指针到委托中，obj析构后该成员函数不再被调用
+     * @param priority 优先级，优先级高的对象先被调用，优先级相同的对象按添加顺序调用，默认为0
+     * @return         新对象在委托中的索引
+     * @note           T需公开继承Trackable。对象析构后调用到该项时返回TRet()，该项在委托下次添加对象前或调用RemoveExpired时被移除
+     */
+    template <typename T>
+    size_t AddWeak(T &obj, TRet (T::*func)(Args...), int priority = 0)
+    {
+        static_assert(std::is_base_of<Trackable, T>::value, "T must derive from Trackable");
+        static_assert(std::is_void<TRet>::value || std::is_default_constructible<TRet>::value,
+                      "Weak subscriptions require a void or default constructible return type");
+        return _data.template EmplaceWithPriority<_WeakMemberFuncWrapper<T>>(priority, obj, func);
+    }
+
+    /**
+     * @brief          以弱订阅的形式添加一个常量成员函数指针到委托中，obj析构后该成员函数不再被调用
+     * @param priority 优先级，优先级高的对象先被调用，优先级相同的对象按添加顺序调用，默认为0
+     * @return         新对象在委托中的索引
+     * @note           T需公开继承Trackable。对象析构后调用到该项时返回TRet()，该项在委托下次添加对象前或调用RemoveExpired时被移除
+     */
+    template <typename T>
+    size_t AddWeak(const T &obj, TRet (T::*func)(Args...) const, int priority = 0)
+    {
+        static_assert(std::is_base_of<Trackable, T>::value, "T must derive from Trackable");
+        static_assert(std::is_void<TRet>::value || std::is_default_constructible<TRet>::value,
+                      "Weak subscriptions require a void or default constructible return type");
+        return _data.template EmplaceWithPriority<_WeakConstMemberFuncWrapper<T>>(priority, obj, func);
+    }
+
+    /**
+     * @brief          依次将range中的每个元素添加到委托中，元素可以是Add接受的任意可调用对象
+     * @param priority 所有元素的优先级，默认为0
+     * @note           range的迭代器至少为前向迭代器时，添加前按元素数量一次性预留空间
+     */
+    template <typename TRange>
+    void AddRange(const TRange &range, int priority = 0)
+    {
+        using std::begin;
+        using std::end;
+        auto first = begin(range);
+        auto last  = end(range);
+        _ReserveRange(first, last, typename std::iterator_traits<decltype(first)>::iterator_category());
+        for (; first != last; ++first) {
+            Add(*first, priority);
+        }
+    }
+
+    /**
+     * @brief          依次将列表中的每个元素添加到委托中，如d.AddRange({f, g, h})
+     * @param priority 所有元素的优先级，默认为0
+     */
+    template <typename T>
+    void AddRange(std::initializer_list<T> list, int priority = 0)
+    {
+        AddRange<std::initializer_list<T>>(list, priority);
+    }
+
+    /**
+     * @brief 清空委托中的所有可调用对象
+     */
+    void Clear()
+    {
+        _data.Clear();
+    }
+
+    /**
+     * @brief 预留至少能存储capacity个可调用对象的空间，批量添加前调用可以避免多次重新分配内存
+     */
+    void Reserve(size_t capacity)
+    {
+        _data.Reserve(capacity);
+    }
+
+    /**
+     * @brief 释放多余的存储空间，只剩一个可调用对象时将其移回委托内部
+     * @note  持有令牌的对象不会被移回委托内部
+     */
+    void Compact()
+    {
+        _data.Compact();
+    }
+
+    /**
+     * @brief  移除所有对象已析构的弱订阅
+     * @return 被移除的数量
+     * @note   调用期间发现的失效项会在下次添加对象前自动移除，通常无需手动调用
+     */
+    size_t RemoveExpired()
+    {
+        return _data.RemoveExpired();
+    }
+
+    /**
+     * @brief  移除一个可调用对象
+     * @return 如果成功移除则返回true，否则返回false
+     * @note   按照添加顺序从后向前查找，找到第一个匹配的可调用对象并移除
+     */
+    bool Remove(const ICallable<TRet(Args...)> &callable)
+    {
+        // 当移除的可调用对象与当前委托类型相同时（与Add和Combine逻辑相对应）：
+        // - 若委托内容为空，则直接返回false
+        // - 若委托内容只有一个元素，则尝试移除该元素
+        // - 否则，先尝试移除通过Add添加的委托，找不到时移除与其内容相同的连续子序列（见Combine）
+        if (callable.GetType() == GetType()) {
+            auto &delegate = static_cast<const Delegate &>(callable);
+            if (delegate._data.IsEmpty()) {
+                return false;
+            } else if (delegate._data.Count() == 1) {
+                return _Remove(*delegate._data[0]);
+            }
+            return _Remove(callable) || _data.RemoveSequence(delegate._data);
+        }
+        return _Remove(callable);
+    }
+
+    /**
+     * @brief  移除一个函数指针
+     * @return 如果成功移除则返回true，否则返回false
+     * @note   按照添加顺序从后向前查找，找到第一个匹配的函数指针并移除
+     */
+    bool Remove(TRet (*func)(Args...))
+    {
+        if (func == nullptr) {
+            return false;
+        }
+        if (_data.GetFunction() == func) {
+            _data.Clear();
+            return true;
+        }
+        return _Remove(_CallableWrapper<decltype(func)>(func));
+    }
+
+    /**
+     * @brief  移除一个可调用对象
+     * @return 如果成功移除则返回true，否则返回false
+     * @note   按照添加顺序从后向前查找，找到第一个匹配的可调用对象并移除
+     */
+    template <typename T>
+    typename std::enable_if<!std::is_base_of<_ICallable, T>::value, bool>::type
+    Remove(const T &callable)
+    {
+        return _Remove(_CallableWrapper<T>(callable));
+    }
+
+    /**
+     * @brief  移除一个成员函数指针
+     * @return 如果成功移除则返回true，否则返回false
+     * @note   按照添加顺序从后向前查找，找到第一个匹配的可调用对象并移除；
+     *         在编译期绑定的相同对象和成员函数（见Add<T, &T::Method>）同样可以匹配
+     */
+    template <typename T>
+    bool Remove(T &obj, TRet (T::*func)(Args...))
+    {
+        return _Remove(_MemberFuncWrapper<T>(obj, func));
+    }
+
+    /**
+     * @brief  移除一个常量成员函数指针
+     * @return 如果成功移除则返回true，否则返回false
+     * @note   按照添加顺序从后向前查找，找到第一个匹配的可调用对象并移除；
+     *         在编译期绑定的相同对象和成员函数（见Add<T, &T::Method>）同样可以匹配
+     */
+    template <typename T>
+    bool Remove(const T &obj, TRet (T::*func)(Args...) const)
+    {
+        return _Remove(_ConstMemberFuncWrapper<T>(obj, func));
+    }
+
+    /**
+     * @brief  移除一个在编译期绑定的成员函数，用法为Remove<T, &T::Method>(obj)
+     * @return 如果成功移除则返回true，否则返回false
+     * @note   按照添加顺序从后向前查找，找到第一个对象和成员函数均相同的项并移除
+     */
+    template <typename T, TRet (T::*Method)(Args...)>
+    bool Remove(T &obj)
+    {
+        return _Remove(_BoundMemberFuncWrapper<T, decltype(Method), Method>(obj));
+    }
+
+    /**
+     * @brief  移除一个在编译期绑定的常量成员函数，用法为Remove<T, &T::Method>(obj)
+     * @return 如果成功移除则返回true，否则返回false
+     * @note   按照添加顺序从后向前查找，找到第一个对象和成员函数均相同的项并移除
+     */
+    template <typename T, TRet (T::*Method)(Args...) const>
+    bool Remove(const T &obj)
+    {
+        return _Remove(_BoundMemberFuncWrapper<const T, decltype(Method), Method>(obj));
+    }
+
+#if defined(DELEGATE_HAS_AUTO_TEMPLATE_PARAMETER)
+    /**
+     * @brief  移除一个在编译期绑定的成员函数或常量成员函数，用法为Remove<&T::Method>(obj)
+     * @return 如果成功移除则返回true，否则返回false
+     * @note   按照添加顺序从后向前查找，找到第一个对象和成员函数均相同的项并移除
+     */
+    template <auto Method>
+    bool Remove(typename _MemberFuncOwner<decltype(Method)>::type &obj)
+    {
+        return _Remove(_BoundWrapperOf<Method>(obj));
+    }
+#endif
+
+    /**
+     * @brief  移除一个弱订阅的成员函数指针
+     * @return 如果成功移除则返回true，否则返回false
+     * @note   按照添加顺序从后向前查找，找到第一个匹配的可调用对象并移除
+     */
+    template <typename T>
+    bool RemoveWeak(T &obj, TRet (T::*func)(Args...))
+    {
+        return _Remove(_WeakMemberFuncWrapper<T>(obj, func));
+    }
+
+    /**
+     * @brief  移除一个弱订阅的常量成员函数指针
+     * @return 如果成功移除则返回true，否则返回false
+     * @note   按照添加顺序从后向前查找，找到第一个匹配的可调用对象并移除
+     */
+    template <typename T>
+    bool RemoveWeak(const T &obj, TRet (T::*func)(Args...) const)
+    {
+        return _Remove(_WeakConstMemberFuncWrapper<T>(obj, func));
+    }
+
+    /**
+     * @brief  移除所有满足条件的可调用对象，pred接受const ICallable<TRet(Args...)> &并返回bool
+     * @return 被移除的数量
+     * @note   只遍历一次委托，调用pred期间不应修改委托
+     */
+    template <typename TPred>
+    size_t RemoveIf(TPred pred)
+    {
+        return _data.RemoveIf(std::move(pred));
+    }
+
+    /**
+     * @brief  移除所有绑定到obj的成员函数，包括弱订阅和编译期绑定的成员函数
+     * @return 被移除的数量
+     * @note   按对象地址比较，obj需与添加时传入的对象为同一类型，否则存在多重继承时地址可能不同
+     */
+    template <typename T>
+    size_t RemoveAll(const T &obj)
+    {
+        return _data.RemoveTarget(std::addressof(obj));
+    }
+
+    /**
+     * @brief  添加一个可调用对象到委托中，并返回用于移除该对象的令牌，参数与Add相同
+     * @return 对应的订阅令牌，若没有添加任何对象则返回空令牌
+     * @note   通过令牌移除对象的代价为O(1)，不需要比较可调用对象
+     */
+    template <typename... TArgs>
+    SubscriptionToken Subscribe(TArgs &&...args)
+    {
+        return _TokenOf(Add(std::forward<TArgs>(args)...));
+    }
+
+    /**
+     * @brief  以弱订阅的形式添加一个成员函数指针，并返回用于移除该对象的令牌，参数与AddWeak相同
+     * @return 对应的订阅令牌，对象析构后该项被移除时令牌随之失效
+     */
+    template <typename... TArgs>
+    SubscriptionToken SubscribeWeak(TArgs &&...args)
+    {
+        return _TokenOf(AddWeak(std::forward<TArgs>(args)...));
+    }
+
+    /**
+     * @brief  移除令牌对应的可调用对象
+     * @return 如果令牌有效且成功移除则返回true，否则返回false
+     */
+    bool Unsubscribe(SubscriptionToken token)
+    {
+        return _data.Remove(token);
+    }
+
+    /**
+     * @brief  判断委托中是否存在与给定对象相等的可调用对象
+     * @return 如果存在则返回true，否则返回false
+     */
+    bool Contains(const ICallable<TRet(Args...)> &callable) const
+    {
+        // 与Remove逻辑相对应，只含一个元素的委托按其元素查找
+        if (callable.GetType() == GetType()) {
+            auto &delegate = static_cast<const Delegate &>(callable);
+            if (delegate._data.IsEmpty()) {
+                return false;
+            } else if (delegate._data.Count() == 1) {
+                return _data.Contains(*delegate._data[0]);
+            }
+        }
+        return _data.Contains(callable);
+    }
+
+    /**
+     * @brief  判断委托中是否存在给定的函数指针
+     * @return 如果存在则返回true，否则返回false
+     */
+    bool Contains(TRet (*func)(Args...)) const
+    {
+        if (func == nullptr) {
+            return false;
+        }
+        return _data.Contains(_CallableWrapper<decltype(func)>(func));
+    }
+
+    /**
+     * @brief  判断委托中是否存在与给定对象相等的可调用对象
+     * @return 如果存在则返回true，否则返回false
+     */
+    template <typename T>
+    typename std::enable_if<!std::is_base_of<_ICallable, T>::value, bool>::type
+    Contains(const T &callable) const
+    {
+        return _data.Contains(_CallableWrapper<T>(callable));
+    }
+
+    /**
+     * @brief  判断委托中是否存在给定的成员函数
+     * @return 如果存在则返回true，否则返回false
+     * @note   在编译期绑定的相同对象和成员函数（见Add<T, &T::Method>）同样可以匹配
+     */
+    template <typename T>
+    bool Contains(T &obj, TRet (T::*func)(Args...)) const
+    {
+        return _data.Contains(_MemberFuncWrapper<T>(obj, func));
+    }
+
+    /**
+     * @brief  判断委托中是否存在给定的常量成员函数
+     * @return 如果存在则返回true，否则返回false
+     * @note   在编译期绑定的相同对象和成员函数（见Add<T, &T::Method>）同样可以匹配
+     */
+    template <typename T>
+    bool Contains(const T &obj, TRet (T::*func)(Args...) const) const
+    {
+        return _data.Contains(_ConstMemberFuncWrapper<T>(obj, func));
+    }
+
+    /**
+     * @brief 设置是否为存储的可调用对象建立哈希索引
+     * @note  适用于存储大量可调用对象的委托，启用后Remove和Contains的平均代价为O(1)，
+     *        仍然优先移除最后添加的匹配对象；该设置在复制委托时一并复制
+     */
+    void SetIndexed(bool indexed)
+    {
+        _data.SetIndexed(indexed);
+    }
+
+    /**
+     * @brief 判断是否启用了哈希索引
+     */
+    bool IsIndexed() const noexcept
+    {
+        return _data.IsIndexed();
+    }
+
+#if defined(DELEGATE_HAS_MEMORY_RESOURCE)
+    /**
+     * @brief 获取分配内存使用的内存资源，为nullptr时表示使用全局operator new
+     */
+    std::pmr::memory_resource *GetMemoryResource() const noexcept
+    {
+        return _data.GetMemoryResource();
+    }
+#endif
+
+    /**
+     * @brief      调用委托，执行所有存储的可调用对象
+     * @param args 函数参数
+     * @return     最后一个可调用对象的返回值
+     * @throw      std::runtime_error 如果委托为空
+     */
+    TRet operator()(Args... args) const
+    {
+        return _InvokeImpl(true, args...);
+    }
+
+    /**
+     * @brief       判断当前委托是否等于另一个委托
+     * @param other 另一个委托
+     * @return      如果相等则返回true，否则返回false
+     */
+    bool operator==(const Delegate &other) const
+    {
+        return Equals(other);
+    }
+
+    /**
+     * @brief       判断当前委托是否不等于另一个委托
+     * @param other 另一个委托
+     * @return      如果不相等则返回true，否则返回false
+     */
+    bool operator!=(const Delegate &other) const
+    {
+        return !Equals(other);
+    }
+
+    /**
+     * @brief  判断当前委托是否等于nullptr
+     * @return 如果委托为空则返回true，否则返回false
+     */
+    bool operator==(std::nullptr_t) const noexcept
+    {
+        return _data.IsEmpty();
+    }
+
+    /**
+     * @brief  判断当前委托是否不等于nullptr
+     * @return 如果委托不为空则返回true，否则返回false
+     */
+    bool operator!=(std::nullptr_t) const noexcept
+    {
+        return !_data.IsEmpty();
+    }
+
+    /**
+     * @brief  判断当前委托是否有效
+     * @return 如果委托不为空则返回true，否则返回false
+     */
+    operator bool() const noexcept
+    {
+        return !_data.IsEmpty();
+    }
+
+    /**
+     * @brief 添加一个可调用对象到委托中
+     * @note  该函数调用Add函数
+     */
+    Delegate &operator+=(const ICallable<TRet(Args...)> &callable)
+    {
+        Add(callable);
+        return *this;
+    }
+
+    /**
+     * @brief 添加一个函数指针到委托中
+     * @note  该函数调用Add函数
+     */
+    Delegate &operator+=(TRet (*func)(Args...))
+    {
+        Add(func);
+        return *this;
+    }
+
+    /**
+     * @brief 添加一个可调用对象到委托中
+     * @note  该函数调用Add函数
+     */
+    template <typename T>
+    typename std::enable_if<!std::is_base_of<_ICallable, T>::value, Delegate &>::type
+    operator+=(const T &callable)
+    {
+        Add(callable);
+        return *this;
+    }
+
+    /**
+     * @brief 添加一个右值可调用对象到委托中
+     * @note  该函数调用Add函数，对象将被移动到委托中
+     */
+    template <typename T>
+    typename std::enable_if<!std::is_reference<T>::value && !std::is_base_of<_ICallable, T>::value, Delegate &>::type
+    operator+=(T &&callable)
+    {
+        Add(std::move(callable));
+        return *this;
+    }
+
+    /**
+     * @brief 移除一个可调用对象
+     * @note  该函数调用Remove函数
+     */
+    Delegate &operator-=(const ICallable<TRet(Args...)> &callable)
+    {
+        Remove(callable);
+        return *this;
+    }
+
+    /**
+     * @brief 移除一个函数指针
+     * @note  该函数调用Remove函数
+     */
+    Delegate &operator-=(TRet (*func)(Args...))
+    {
+        Remove(func);
+        return *this;
+    }
+
+    /**
+     * @brief 移除一个可调用对象
+     * @note  该函数调用Remove函数
+     */
+    template <typename T>
+    typename std::enable_if<!std::is_base_of<_ICallable, T>::value, Delegate &>::type
+    operator-=(const T &callable)
+    {
+        Remove(callable);
+        return *this;
+    }
+
+    /**
+     * @brief 合并两个委托，等同于Combine(*this, other)
+     */
+    Delegate operator+(const Delegate &other) const
+    {
+        return Combine(*this, other);
+    }
+
+    /**
+     * @brief 从当前委托中移除other的所有可调用对象组成的最后一段连续对象，等同于Remove(*this, other)
+     */
+    Delegate operator-(const Delegate &other) const
+    {
+        return Remove(*this, other);
+    }
+
+    /**
+     * @brief      调用委托，执行所有存储的可调用对象
+     * @param args 函数参数
+     * @return     最后一个可调用对象的返回值
+     * @throw      std::runtime_error 如果委托为空
+     */
+    virtual TRet Invoke(Args... args) const override
+    {
+        return _InvokeImpl(true, args...);
+    }
+
+    /**
+     * @brief  克隆当前委托
+     * @return 返回一个新的Delegate对象，包含相同的可调用对象
+     */
+    virtual ICallable<TRet(Args...)> *Clone() const override
+    {
+        return new Delegate(*this);
+    }
+
+    /**
+     * @brief  深拷贝当前委托
+     * @return 返回一个新的Delegate对象，其中的可调用对象均为原对象的副本，不与当前委托共享状态
+     * @throw  std::runtime_error 如果存在不可复制的可调用对象
+     */
+    Delegate DeepClone() const
+    {
+        Delegate result;
+        result._data.CopySettings(_data);
+        result._data.Append(_data, true);
+        return result;
+    }
+
+    /**
+     * @brief  合并两个委托，返回包含a和b中所有可调用对象的新委托，与C#中的Delegate.Combine相同
+     * @note   与Add(b)将b作为一个嵌套的委托添加不同，合并结果只有一层列表，调用开销与直接逐个添加的委托相同。
+     *         各对象保留其优先级，调用顺序与先添加a的所有对象、再添加b的所有对象相同：优先级相同时a的对象先于b的对象，
+     *         b中优先级更高的对象则先于a中的对象被调用。存储在堆上的可调用对象在a、b与结果之间共享而不是复制，
+     *         结果总是使用a的内存资源和索引设置
+     */
+    static Delegate Combine(const Delegate &a, const Delegate &b)
+    {
+        Delegate result(a);
+        if (!b._data.IsEmpty()) {
+            result._data.Reserve(a._data.Count() + b._data.Count());
+            result._data.Append(b._data);
+        }
+        return result;
+    }
+
+    /**
+     * @brief  从source中移除与value的所有可调用对象依次相等的最后一段连续对象，返回移除后的新委托，与C#中的Delegate.Remove相同
+     * @note   找不到时返回与source相同的委托，source本身不会被修改
+     */
+    static Delegate Remove(const Delegate &source, const Delegate &value)
+    {
+        Delegate result(source);
+        result._data.RemoveSequence(value._data);
+        return result;
+    }
+
+    /**
+     * @brief  获取当前委托的类型信息
+     * @return 返回TypeId::Of<Delegate<TRet(Args...)>>()
+     */
+    virtual TypeId GetType() const override
+    {
+        return TypeId::Of<Delegate<TRet(Args...)>>();
+    }
+
+    /**
+     * @brief       判断当前委托是否与另一个可调用对象相等
+     * @param other 另一个可调用对象
+     * @return      如果相等则返回true，否则返回false
+     */
+    virtual bool Equals(const ICallable<TRet(Args...)> &other) const override
+    {
+        if (this == &other) {
+            return true;
+        }
+        if (GetType() != other.GetType()) {
+            return false;
+        }
+        const auto &otherDelegate = static_cast<const Delegate &>(other);
+        return _data.SequenceEqual(otherDelegate._data);
+    }
+
+    /**
+     * @brief  获取当前委托的哈希值
+     * @return 按顺序组合所有可调用对象的哈希值
+     */
+    virtual size_t GetHashCode() const noexcept override
+    {
+        return _data.SequenceHash();
+    }
+
+    /**
+     * @brief      调用所有存储的可调用对象，并返回它们的结果
+     * @param args 函数参数
+     * @return     返回一个包含所有可调用对象返回值的vector
+     */
+    template <typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, std::vector<U>>::type
+    InvokeAll(Args... args) const
+    {
+        std::vector<U> results;
+        if (_data.IsEmpty()) {
+            _ThrowEmptyDelegateError();
+        }
+        results.reserve(_data.Count());
+        auto sink = [&results](U &&result) { results.emplace_back(std::forward<U>(result)); };
+        _InvokeEach(sink, args...);
+        return results;
+    }
+
+    /**
+     * @brief      调用所有存储的可调用对象，并将它们的结果依次写入输出迭代器，不产生额外的内存分配
+     * @param out  输出迭代器，调用者需保证其能够容纳所有结果
+     * @param args 函数参数
+     * @return     写入最后一个结果之后的输出迭代器
+     * @throw      std::runtime_error 如果委托为空
+     */
+    template <typename TOutputIt, typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, TOutputIt>::type
+    InvokeAll(TOutputIt out, Args... args) const
+    {
+        auto sink = [&out](U &&result) { *out = std::forward<U>(result); ++out; };
+        _InvokeEach(sink, args...);
+        return out;
+    }
+
+    /**
+     * @brief      调用所有存储的可调用对象，并使用op依次合并它们的结果，不产生额外的内存分配
+     * @param init 初始值
+     * @param op   合并函数，形如TAcc(TAcc, TRet)，依次接收当前的累积值和每个可调用对象的返回值
+     * @param args 函数参数
+     * @return     合并后的结果
+     * @throw      std::runtime_error 如果委托为空
+     */
+    template <typename TAcc, typename TOp, typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, TAcc>::type
+    InvokeReduce(TAcc init, TOp op, Args... args) const
+    {
+        auto sink = [&init, &op](U &&result) { init = op(std::move(init), std::forward<U>(result)); };
+        _InvokeEach(sink, args...);
+        return init;
+    }
+
+    /**
+     * @brief          在执行器上异步调用委托
+     * @param executor 执行器，需提供Post成员函数接受形如void()的任务，如ThreadPool
+     * @param args     函数参数，非常量左值引用参数保存引用，调用者需保证其在调用完成前有效，其余参数保存副本
+     * @return         返回一个std::future，用于获取最后一个可调用对象的返回值或调用时抛出的异常
+     * @throw          std::runtime_error 如果委托为空
+     * @note           调用的是当前委托的副本，之后对委托的修改不影响本次调用
+     */
+    template <typename TExecutor>
+    std::future<TRet> InvokeAsync(TExecutor &executor, Args... args) const
+    {
+        if (_data.IsEmpty()) {
+            _ThrowEmptyDelegateError();
+        }
+        auto call                = std::make_shared<_AsyncCall>(*this, args...);
+        std::future<TRet> future = call->promise.get_future();
+        executor.Post([call] { call->Run(); });
+        return future;
+    }
+
+#if defined(DELEGATE_HAS_COROUTINE)
+    /**
+     * @brief          获取一个可以co_await的对象，等待时在执行器上调用委托，完成后协程在执行器的线程上恢复
+     * @param executor 执行器，需提供Post成员函数接受形如void()的任务，如ThreadPool
+     * @param args     函数参数，非常量左值引用参数保存引用，其余参数保存副本
+     * @return         可以co_await的对象，co_await的结果为最后一个可调用对象的返回值
+     * @throw          std::runtime_error 如果委托为空
+     */
+    template <typename TExecutor>
+    _InvokeAwaiter<TExecutor> InvokeAwaitable(TExecutor &executor, Args... args) const
+    {
+        if (_data.IsEmpty()) {
+            _ThrowEmptyDelegateError();
+        }
+        return _InvokeAwaiter<TExecutor>(executor, *this, args...);
+    }
+#endif
+
+    /**
+     * @brief          在执行器上并行调用所有存储的可调用对象，并按添加顺序返回它们的结果
+     * @param executor 执行器，需提供Post成员函数接受形如void()的任务，如ThreadPool
+     * @param args     函数参数，所有对象共享同一组参数，参数不会被移动
+     * @return         返回一个包含所有可调用对象返回值的vector
+     * @throw          std::runtime_error 如果委托为空；若有对象抛出异常，则在所有对象结束后重新抛出位置最靠前的异常
+     * @note           调用线程同样参与执行，并等待所有对象结束后返回；只有一个可调用对象时直接在调用线程上执行。
+     *                 可调用对象之间应相互独立，且不应在调用期间修改当前委托
+     */
+    template <typename TExecutor, typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, std::vector<U>>::type
+    InvokeAllParallel(TExecutor &executor, Args... args) const
+    {
+        std::vector<U> results;
+        if (_data.Count() <= 1) {
+            auto sink = [&results](U &&result) { results.emplace_back(std::forward<U>(result)); };
+            _InvokeEach(sink, args...);
+            return results;
+        }
+
+        struct _Storage {
+            alignas(U) unsigned char bytes[sizeof(U)];
+        };
+
+        typename CallableList<TRet(Args...)>::InvokeScope list(_data);
+        size_t count = list.Count();
+        std::vector<_Storage> storage(count);
+        std::vector<char> constructed(count, 0);
+        std::vector<std::exception_ptr> errors(count);
+
+        auto run = [&](size_t i) {
+            if (list[i] == nullptr) return;
+            try {
+                new (storage[i].bytes) U(list.InvokeAt(i, false, args...));
+                constructed[i] = 1;
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        };
+
+        auto state = std::make_shared<_ParallelState<decltype(run)>>(run, count);
+        try {
+            for (size_t i = 1; i < count; ++i) {
+                executor.Post([state] { state->Work(); });
+            }
+        } catch (...) {
+            // 提交失败时剩余的对象由调用线程执行
+        }
+        state->Work();
+        state->Wait();
+
+        std::exception_ptr error;
+        for (size_t i = 0; i < count && error == nullptr; ++i) {
+            error = errors[i];
+        }
+        size_t i = 0;
+        try {
+            if (error == nullptr) {
+                results.reserve(_data.Count());
+                for (; i < count; ++i) {
+                    if (!constructed[i]) continue;
+                    U &value = *reinterpret_cast<U *>(storage[i].bytes);
+                    results.emplace_back(std::move(value));
+                    value.~U();
+                    constructed[i] = 0;
+                }
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+        for (; i < count; ++i) {
+            if (constructed[i]) reinterpret_cast<U *>(storage[i].bytes)->~U();
+        }
+        if (error != nullptr) {
+            std::rethrow_exception(error);
+        }
+        return results;
+    }
+
+    /**
+     * @brief      依次调用存储的可调用对象，直到某个对象的返回值满足pred
+     * @param pred 判断函数，形如bool(const TRet &)，返回true时停止调用剩余的对象
+     * @param args 函数参数
+     * @return     最后一个被调用的可调用对象的返回值
+     * @throw      std::runtime_error 如果委托为空
+     */
+    template <typename TPred, typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, TRet>::type
+    InvokeUntil(TPred pred, Args... args) const
+    {
+        auto cond = [&pred](const U &result) -> bool { return !pred(result); };
+        return _InvokeWhileImpl(cond, args...);
+    }
+
+    /**
+     * @brief      依次调用存储的可调用对象，直到某个对象的返回值不满足pred
+     * @param pred 判断函数，形如bool(const TRet &)，返回false时停止调用剩余的对象
+     * @param args 函数参数
+     * @return     最后一个被调用的可调用对象的返回值
+     * @throw      std::runtime_error 如果委托为空
+     */
+    template <typename TPred, typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, TRet>::type
+    InvokeWhile(TPred pred, Args... args) const
+    {
+        auto cond = [&pred](const U &result) -> bool { return static_cast<bool>(pred(result)); };
+        return _InvokeWhileImpl(cond, args...);
+    }
+
+    /**
+     * @brief      依次调用存储的可调用对象，直到flag被设置
+     * @param flag 取消标志，在调用每个对象之前检查，返回值被忽略
+     * @param args 函数参数
+     * @return     如果调用因取消而提前结束则返回true，否则返回false
+     * @throw      std::runtime_error 如果委托为空
+     */
+    bool InvokeUntil(const CancellationFlag &flag, Args... args) const
+    {
+        if (_data.IsEmpty()) {
+            _ThrowEmptyDelegateError();
+        }
+        typename CallableList<TRet(Args...)>::InvokeScope list(_data);
+        size_t count = list.Count();
+        for (size_t i = 0; i < count; ++i) {
+            if (flag.IsCancelled()) return true;
+            if (list[i] != nullptr) list.InvokeAt(i, i == count - 1, args...);
+        }
+        return false;
+    }
+
+private:
+    /**
+     * @brief 并行调用的共享状态，由调用线程和提交到执行器的任务共同持有
+     * @note  各线程通过next领取待执行的位置，领取完毕后执行器中尚未开始的任务不再访问调用者的数据
+     */
+    template <typename TRun>
+    struct _ParallelState {
+        TRun &run;
+        size_t count;
+        std::atomic<size_t> next;
+        size_t done = 0;
+        std::mutex mutex;
+        std::condition_variable cv;
+
+        _ParallelState(TRun &run, size_t count)
+            : run(run), count(count), next(0)
+        {
+        }
+
+        void Work()
+        {
+            size_t i, finished = 0;
+            while ((i = next.fetch_add(1, std::memory_order_relaxed)) < count) {
+                run(i);
+                ++finished;
+            }
+            if (finished != 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                done += finished;
+                if (done == count) cv.notify_all();
+            }
+        }
+
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return done == count; });
+        }
+    };
+
+    /**
+     * @brief 内部函数，用于从后向前查找并移除一个可调用对象
+     */
+    bool _Remove(const _ICallable &callable)
+    {
+        return _data.Remove(callable);
+    }
+
+    /**
+     * @brief 内部函数，AddRange添加前按元素数量预留空间，输入迭代器无法预先计数
+     */
+    template <typename TIterator>
+    void _ReserveRange(TIterator first, TIterator last, std::forward_iterator_tag)
+    {
+        _data.Reserve(_data.Count() + static_cast<size_t>(std::distance(first, last)));
+    }
+
+    template <typename TIterator>
+    void _ReserveRange(TIterator, TIterator, std::input_iterator_tag)
+    {
+    }
+
+    /**
+     * @brief 内部函数，获取刚添加的对象的令牌，获取失败时移除该对象，index为SIZE_MAX时返回空令牌
+     */
+    SubscriptionToken _TokenOf(size_t index)
+    {
+        if (index == SIZE_MAX) {
+            return SubscriptionToken();
+        }
+        try {
+            return _data.GetToken(index);
+        } catch (...) {
+            _data.RemoveAt(index);
+            throw;
+        }
+    }
+
+    /**
+     * @brief 内部函数，调用空委托时抛出异常
+     */
+    [[noreturn]] void _ThrowEmptyDelegateError() const
+    {
+        throw std::runtime_error("Delegate is empty");
+    }
+
+    /**
+     * @brief 内部函数，Invoke和operator()的实现
+     * @note  参数以引用的形式传递给各个可调用对象，最后一个之外的对象以共享的形式接收参数，
+     *        forward为true时最后一个对象接收转发（移动）的参数
+     */
+    inline TRet _InvokeImpl(bool forward, _ArgRef<Args>... args) const
+    {
+        // 只包含一个函数指针时直接调用，调用后不再访问列表，因此无需创建调用作用域
+        auto function = _data.GetFunction();
+        if (function != nullptr) {
+            if (forward) return _List::InvokeForward(function, args...);
+            return _List::InvokeShared(function, args...);
+        }
+        if (_data.IsEmpty()) {
+            _ThrowEmptyDelegateError();
+        }
+        typename CallableList<TRet(Args...)>::InvokeScope list(_data);
+        size_t count = list.Count();
+        for (size_t i = 0; i < count - 1; ++i) {
+            if (list[i] != nullptr) list.InvokeAt(i, false, args...);
+        }
+        return list.InvokeAt(count - 1, forward, args...);
+    }
+
+    /**
+     * @brief 内部函数，调用所有存储的可调用对象，并将每个返回值依次传递给sink
+     */
+    template <typename TSink>
+    void _InvokeEach(TSink &sink, _ArgRef<Args>... args) const
+    {
+        if (_data.IsEmpty()) {
+            _ThrowEmptyDelegateError();
+        }
+        typename CallableList<TRet(Args...)>::InvokeScope list(_data);
+        size_t count = list.Count();
+        for (size_t i = 0; i < count; ++i) {
+            if (list[i] != nullptr) sink(list.InvokeAt(i, i == count - 1, args...));
+        }
+    }
+
+    /**
+     * @brief 内部函数，依次调用存储的可调用对象，直到某个对象的返回值使cond返回false
+     * @note  由于无法预知在哪个对象处停止，只有最后一个存储槽中的对象接收转发的参数
+     */
+    template <typename TCond>
+    TRet _InvokeWhileImpl(TCond &cond, _ArgRef<Args>... args) const
+    {
+        if (_data.IsEmpty()) {
+            _ThrowEmptyDelegateError();
+        }
+        typename CallableList<TRet(Args...)>::InvokeScope list(_data);
+        size_t count = list.Count();
+        for (size_t i = 0; i < count - 1; ++i) {
+            if (list[i] == nullptr) continue;
+            TRet result = list.InvokeAt(i, false, args...);
+            if (!cond(result)) return result;
+        }
+        return list.InvokeAt(count - 1, true, args...);
+    }
+
+    /**
+     * @brief 内部函数，作为其他委托中的可调用对象被调用时由存储槽使用
+     */
+    TRet InvokeWith(bool forward, _ArgRef<Args>... args) const
+    {
+        return _InvokeImpl(forward, args...);
+    }
+};
+
+/**
+ * @brief 一次异步调用的状态，保存调用时委托的副本和参数
+ */
+template <typename TRet, typename... Args>
+struct Delegate<TRet(Args...)>::_AsyncCall {
+    Delegate delegate;
+    std::tuple<_StoredArg<Args>...> args;
+    std::promise<TRet> promise;
+
+    _AsyncCall(const Delegate &delegate, _ArgRef<Args>... values)
+        : delegate(delegate), args(static_cast<Args &&>(values)...)
+    {
+    }
+
+    /**
+     * @brief 调用委托，并将结果或异常保存到promise中
+     */
+    void Run() noexcept
+    {
+        try {
+            _Complete(typename _MakeIndexSequence<sizeof...(Args)>::type(), std::is_void<TRet>());
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
+
+private:
+    template <size_t... Indices>
+    void _Complete(_IndexSequence<Indices...>, std::false_type)
+    {
+        promise.set_value(delegate._InvokeImpl(true, std::get<Indices>(args)...));
+    }
+
+    template <size_t... Indices>
+    void _Complete(_IndexSequence<Indices...>, std::true_type)
+    {
+        delegate._InvokeImpl(true, std::get<Indices>(args)...);
+        promise.set_value();
+    }
+};
+
+#if defined(DELEGATE_HAS_COROUTINE)
+/**
+ * @brief 可以co_await的异步调用，挂起时将调用提交到执行器，调用完成后在执行器的线程上恢复协程
+ */
+template <typename TRet, typename... Args>
+template <typename TExecutor>
+class Delegate<TRet(Args...)>::_InvokeAwaiter
+{
+    TExecutor &_executor;
+    _AsyncCall _call;
+    std::future<TRet> _future;
+
+public:
+    _InvokeAwaiter(TExecutor &executor, const Delegate &delegate, _ArgRef<Args>... args)
+        : _executor(executor), _call(delegate, args...), _future(_call.promise.get_future())
+    {
+    }
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        _executor.Post([this, handle] {
+            _call.Run();
+            handle.resume();
+        });
+    }
+
+    TRet await_resume()
+    {
+        return _future.get();
+    }
+};
+#endif
+
+/*================================================================================*/
+
+/**
+ * @brief 比较委托和nullptr
+ * @note  如果委托为空则返回true，否则返回false
+ */
+template <typename TRet, typename... Args>
+inline bool operator==(std::nullptr_t, const Delegate<TRet(Args...)> &d) noexcept
+{
+    return d == nullptr;
+}
+
+/**
+ * @brief 比较委托和nullptr
+ * @note  如果委托不为空则返回true，否则返回false
+ */
+template <typename TRet, typename... Args>
+inline bool operator!=(std::nullptr_t, const Delegate<TRet(Args...)> &d) noexcept
+{
+    return d != nullptr;
+}
+
+/*================================================================================*/
+
+/**
+ * @brief 线程安全的委托，适用于调用频繁而修改较少的场景
+ * @note  调用时读取一个不可变的委托快照，不加锁且不会阻塞；修改操作之间通过互斥锁串行化，
+ *        每次修改生成新的快照。被替换的快照记录退役时的纪元，由后续的修改或Reclaim在
+ *        可能持有它的调用结束后逐个释放，调用方自身不会执行任何释放操作
+ */
+template <typename TRet, typename... Args>
+class ConcurrentDelegate<TRet(Args...)>
+{
+public:
+    /**
+     * @brief 快照类型别名
+     */
+    using TDelegate = Delegate<TRet(Args...)>;
+
+private:
+    /**
+     * @brief 委托快照
+     */
+    struct _Snapshot {
+        TDelegate value;
+        _Snapshot *next; // 待释放链表中的下一个快照
+        size_t epoch;    // 退役时的纪元
+
+        _Snapshot()
+            : next(nullptr), epoch(0)
+        {
+        }
+        explicit _Snapshot(const TDelegate &value)
+            : value(value), next(nullptr), epoch(0)
+        {
+        }
+    };
+
+    /**
+     * @brief 缓存行大小
+     */
+    static constexpr size_t _CACHE_LINE = 64;
+
+    /**
+     * @brief 读者计数器，按纪元奇偶分为两组，大小为一个缓存行
+     */
+    struct _ReaderCounter {
+        std::atomic<size_t> value[2];
+        uint8_t padding[_CACHE_LINE - 2 * sizeof(std::atomic<size_t>)];
+    };
+    static_assert(sizeof(_ReaderCounter) == _CACHE_LINE, "_ReaderCounter must occupy exactly one cache line");
+
+    /**
+     * @brief 读者计数器的数量，不同线程分散到不同的计数器上
+     */
+    static constexpr size_t _STRIPES = DELEGATE_CONCURRENT_STRIPES;
+
+    /**
+     * @brief 当前快照，为nullptr时表示委托为空
+     */
+    std::atomic<_Snapshot *> _current;
+
+    /**
+     * @brief 待释放的快照链表，由_mutex保护
+     */
+    mutable _Snapshot *_retired = nullptr;
+
+    /**
+     * @brief 当前纪元，读者登记到与其奇偶相同的计数器上
+     * @note  纪元只在另一组计数器全部归零时推进，快照退役后纪元推进两次即可释放
+     */
+    mutable std::atomic<size_t> _epoch;
+
+    /**
+     * @brief 写者互斥锁
+     */
+    mutable std::mutex _mutex;
+
+    /**
+     * @brief 读者计数器的存储空间，多预留一个缓存行，使计数器数组从缓存行边界开始（见_Readers）
+     * @note  不使用alignas(64)，因为C++17之前堆上分配的对象不保证满足超过基本对齐的要求
+     */
+    mutable uint8_t _readerStorage[(_STRIPES + 1) * _CACHE_LINE];
+
+    /**
+     * @brief 读者作用域，持有期间当前线程读取到的快照不会被释放
+     */
+    class _ReadScope
+    {
+        const ConcurrentDelegate &_owner;
+        std::atomic<size_t> &_counter;
+
+    public:
+        explicit _ReadScope(const ConcurrentDelegate &owner) noexcept
+            : _owner(owner), _counter(owner._Readers()[_StripeIndex()].value[owner._epoch.load(std::memory_order_seq_cst) & 1])
+        {
+            _counter.fetch_add(1, std::memory_order_seq_cst);
+        }
+        ~_ReadScope()
+        {
+            // 读者只注销自身，快照的释放由写者或Reclaim完成
+            _counter.fetch_sub(1, std::memory_order_release);
+        }
+        _Snapshot *Get() const noexcept
+        {
+            return _owner._current.load(std::memory_order_seq_cst);
+        }
+    };
+
+public:
+    /**
+     * @brief 默认构造函数
+     */
+    ConcurrentDelegate(std::nullptr_t = nullptr)
+        : _current(nullptr), _epoch(0)
+    {
+        _ReaderCounter *readers = _Readers();
+        for (size_t i = 0; i < _STRIPES; ++i) {
+            new (readers + i) _ReaderCounter;
+            readers[i].value[0].store(0, std::memory_order_relaxed);
+            readers[i].value[1].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief 构造函数，以一个委托的内容初始化
+     */
+    ConcurrentDelegate(const TDelegate &delegate)
+        : ConcurrentDelegate()
+    {
+        if (delegate != nullptr) {
+            _current.store(new _Snapshot(delegate), std::memory_order_relaxed);
+        }
+    }
+
+    ConcurrentDelegate(const ConcurrentDelegate &)            = delete;
+    ConcurrentDelegate &operator=(const ConcurrentDelegate &) = delete;
+
+    /**
+     * @brief 析构函数，调用者需保证析构时没有正在进行的调用
+     */
+    ~ConcurrentDelegate()
+    {
+        delete _current.load(std::memory_order_relaxed);
+        while (_retired != nullptr) {
+            _Snapshot *next = _retired->next;
+            delete _retired;
+            _retired = next;
+        }
+    }
+
+    /**
+     * @brief 添加一个可调用对象，参数与Delegate::Add相同
+     */
+    template <typename... TArgs>
+    void Add(TArgs &&...args)
+    {
+        _Update([&](TDelegate &delegate) {
+            delegate.Add(std::forward<TArgs>(args)...);
+            return true;
+        });
+    }
+
+    /**
+     * @brief 直接构造一个F类型的可调用对象并添加，参数与Delegate::Emplace相同
+     */
+    template <typename F, typename... CtorArgs>
+    void Emplace(CtorArgs &&...args)
+    {
+        _Update([&](TDelegate &delegate) {
+            delegate.template Emplace<F>(std::forward<CtorArgs>(args)...);
+            return true;
+        });
+    }
+
+    /**
+     * @brief  移除一个可调用对象，参数与Delegate::Remove相同
+     * @return 如果成功移除则返回true，否则返回false
+     */
+    template <typename... TArgs>
+    bool Remove(TArgs &&...args)
+    {
+        return _Update([&](TDelegate &delegate) {
+            return delegate.Remove(std::forward<TArgs>(args)...);
+        });
+    }
+
+    /**
+     * @brief  添加一个可调用对象，并返回用于移除该对象的令牌，参数与Delegate::Add相同
+     * @return 对应的订阅令牌，若没有添加任何对象则返回空令牌
+     */
+    template <typename... TArgs>
+    SubscriptionToken Subscribe(TArgs &&...args)
+    {
+        SubscriptionToken token;
+        _Update([&](TDelegate &delegate) {
+            token = delegate.Subscribe(std::forward<TArgs>(args)...);
+            return static_cast<bool>(token);
+        });
+        return token;
+    }
+
+    /**
+     * @brief 以弱订阅的形式添加一个成员函数指针，参数与Delegate::AddWeak相同
+     */
+    template <typename... TArgs>
+    void AddWeak(TArgs &&...args)
+    {
+        _Update([&](TDelegate &delegate) {
+            delegate.AddWeak(std::forward<TArgs>(args)...);
+            return true;
+        });
+    }
+
+    /**
+     * @brief  移除一个弱订阅的成员函数指针，参数与Delegate::RemoveWeak相同
+     * @return 如果成功移除则返回true，否则返回false
+     */
+    template <typename... TArgs>
+    bool RemoveWeak(TArgs &&...args)
+    {
+        return _Update([&](TDelegate &delegate) {
+            return delegate.RemoveWeak(std::forward<TArgs>(args)...);
+        });
+    }
+
+    /**
+     * @brief  以弱订阅的形式添加一个成员函数指针，并返回用于移除该对象的令牌，参数与Delegate::AddWeak相同
+     * @return 对应的订阅令牌
+     */
+    template <typename... TArgs>
+    SubscriptionToken SubscribeWeak(TArgs &&...args)
+    {
+        SubscriptionToken token;
+        _Update([&](TDelegate &delegate) {
+            token = delegate.SubscribeWeak(std::forward<TArgs>(args)...);
+            return static_cast<bool>(token);
+        });
+        return token;
+    }
+
+    /**
+     * @brief  移除所有对象已析构的弱订阅
+     * @return 被移除的数量
+     */
+    size_t RemoveExpired()
+    {
+        size_t removed = 0;
+        _Update([&](TDelegate &delegate) {
+            removed = delegate.RemoveExpired();
+            return removed != 0;
+        });
+        return removed;
+    }
+
+    /**
+     * @brief 依次添加range中的每个元素，参数与Delegate::AddRange相同
+     * @note  所有元素在同一次更新中添加，只产生一个新的快照
+     */
+    template <typename... TArgs>
+    void AddRange(TArgs &&...args)
+    {
+        _Update([&](TDelegate &delegate) {
+            delegate.AddRange(std::forward<TArgs>(args)...);
+            return true;
+        });
+    }
+
+    /**
+     * @brief 依次添加列表中的每个元素，如d.AddRange({f, g, h})
+     */
+    template <typename T>
+    void AddRange(std::initializer_list<T> list, int priority = 0)
+    {
+        AddRange<std::initializer_list<T> &, int &>(list, priority);
+    }
+
+    /**
+     * @brief  移除所有满足条件的可调用对象，参数与Delegate::RemoveIf相同
+     * @return 被移除的数量
+     */
+    template <typename TPred>
+    size_t RemoveIf(TPred pred)
+    {
+        size_t removed = 0;
+        _Update([&](TDelegate &delegate) {
+            removed = delegate.RemoveIf(pred);
+            return removed != 0;
+        });
+        return removed;
+    }
+
+    /**
+     * @brief  移除所有绑定到obj的成员函数，参数与Delegate::RemoveAll相同
+     * @return 被移除的数量
+     */
+    template <typename T>
+    size_t RemoveAll(const T &obj)
+    {
+        size_t removed = 0;
+        _Update([&](TDelegate &delegate) {
+            removed = delegate.RemoveAll(obj);
+            return removed != 0;
+        });
+        return removed;
+    }
+
+    /**
+     * @brief  移除令牌对应的可调用对象
+     * @return 如果令牌有效且成功移除则返回true，否则返回false
+     */
+    bool Unsubscribe(SubscriptionToken token)
+    {
+        return _Update([&](TDelegate &delegate) {
+            return delegate.Unsubscribe(token);
+        });
+    }
+
+    /**
+     * @brief 清空委托中的所有可调用对象
+     */
+    void Clear()
+    {
+        _Update([](TDelegate &delegate) {
+            delegate.Clear();
+            return true;
+        });
+    }
+
+    /**
+     * @brief 添加一个可调用对象
+     * @note  该函数调用Add函数
+     */
+    template <typename T>
+    ConcurrentDelegate &operator+=(T &&callable)
+    {
+        Add(std::forward<T>(callable));
+        return *this;
+    }
+
+    /**
+     * @brief 移除一个可调用对象
+     * @note  该函数调用Remove函数
+     */
+    template <typename T>
+    ConcurrentDelegate &operator-=(T &&callable)
+    {
+        Remove(std::forward<T>(callable));
+        return *this;
+    }
+
+    /**
+     * @brief  获取当前内容的快照
+     * @return 返回与当前内容相同的委托，之后的修改不会影响该快照
+     */
+    TDelegate GetSnapshot() const
+    {
+        _ReadScope scope(*this);
+        _Snapshot *snapshot = scope.Get();
+        return snapshot == nullptr ? TDelegate() : snapshot->value;
+    }
+
+    /**
+     * @brief      调用委托，执行所有存储的可调用对象
+     * @param args 函数参数
+     * @return     最后一个可调用对象的返回值
+     * @throw      std::runtime_error 如果委托为空
+     */
+    TRet operator()(Args... args) const
+    {
+        return Invoke(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief      调用委托，执行所有存储的可调用对象
+     * @param args 函数参数
+     * @return     最后一个可调用对象的返回值
+     * @throw      std::runtime_error 如果委托为空
+     */
+    TRet Invoke(Args... args) const
+    {
+        _ReadScope scope(*this);
+        _Snapshot *snapshot = scope.Get();
+        if (snapshot == nullptr) {
+            throw std::runtime_error("Delegate is empty");
+        }
+        return snapshot->value.Invoke(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief      调用所有存储的可调用对象，并返回它们的结果
+     * @param args 函数参数
+     * @return     返回一个包含所有可调用对象返回值的vector
+     */
+    template <typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, std::vector<U>>::type
+    InvokeAll(Args... args) const
+    {
+        _ReadScope scope(*this);
+        _Snapshot *snapshot = scope.Get();
+        if (snapshot == nullptr) {
+            throw std::runtime_error("Delegate is empty");
+        }
+        return snapshot->value.InvokeAll(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief      调用所有存储的可调用对象，并将它们的结果依次写入输出迭代器，不产生额外的内存分配
+     * @param out  输出迭代器，调用者需保证其能够容纳所有结果
+     * @param args 函数参数
+     * @return     写入最后一个结果之后的输出迭代器
+     */
+    template <typename TOutputIt, typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, TOutputIt>::type
+    InvokeAll(TOutputIt out, Args... args) const
+    {
+        _ReadScope scope(*this);
+        _Snapshot *snapshot = scope.Get();
+        if (snapshot == nullptr) {
+            throw std::runtime_error("Delegate is empty");
+        }
+        return snapshot->value.InvokeAll(std::move(out), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief      调用所有存储的可调用对象，并使用op依次合并它们的结果，不产生额外的内存分配
+     * @param init 初始值
+     * @param op   合并函数，形如TAcc(TAcc, TRet)，依次接收当前的累积值和每个可调用对象的返回值
+     * @param args 函数参数
+     * @return     合并后的结果
+     */
+    template <typename TAcc, typename TOp, typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, TAcc>::type
+    InvokeReduce(TAcc init, TOp op, Args... args) const
+    {
+        _ReadScope scope(*this);
+        _Snapshot *snapshot = scope.Get();
+        if (snapshot == nullptr) {
+            throw std::runtime_error("Delegate is empty");
+        }
+        return snapshot->value.InvokeReduce(std::move(init), std::move(op), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief          在执行器上异步调用委托当前的快照
+     * @param executor 执行器，需提供Post成员函数接受形如void()的任务，如ThreadPool
+     * @param args     函数参数，非常量左值引用参数保存引用，调用者需保证其在调用完成前有效，其余参数保存副本
+     * @return         返回一个std::future，用于获取最后一个可调用对象的返回值或调用时抛出的异常
+     */
+    template <typename TExecutor>
+    std::future<TRet> InvokeAsync(TExecutor &executor, Args... args) const
+    {
+        _ReadScope scope(*this);
+        _Snapshot *snapshot = scope.Get();
+        if (snapshot == nullptr) {
+            throw std::runtime_error("Delegate is empty");
+        }
+        return snapshot->value.InvokeAsync(executor, std::forward<Args>(args)...);
+    }
+
+#if defined(DELEGATE_HAS_COROUTINE)
+    /**
+     * @brief          获取一个可以co_await的对象，等待时在执行器上调用委托当前的快照
+     * @param executor 执行器，需提供Post成员函数接受形如void()的任务，如ThreadPool
+     * @param args     函数参数，非常量左值引用参数保存引用，其余参数保存副本
+     * @return         可以co_await的对象，co_await的结果为最后一个可调用对象的返回值
+     */
+    template <typename TExecutor>
+    auto InvokeAwaitable(TExecutor &executor, Args... args) const
+    {
+        _ReadScope scope(*this);
+        _Snapshot *snapshot = scope.Get();
+        if (snapshot == nullptr) {
+            throw std::runtime_error("Delegate is empty");
+        }
+        return snapshot->value.InvokeAwaitable(executor, std::forward<Args>(args)...);
+    }
+#endif
+
+    /**
+     * @brief          在执行器上并行调用所有存储的可调用对象，并按添加顺序返回它们的结果
+     * @param executor 执行器，需提供Post成员函数接受形如void()的任务，如ThreadPool
+     * @param args     函数参数，所有对象共享同一组参数，参数不会被移动
+     * @return         返回一个包含所有可调用对象返回值的vector
+     * @note           若有对象抛出异常，则在所有对象结束后重新抛出位置最靠前的异常
+     */
+    template <typename TExecutor, typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, std::vector<U>>::type
+    InvokeAllParallel(TExecutor &executor, Args... args) const
+    {
+        _ReadScope scope(*this);
+        _Snapshot *snapshot = scope.Get();
+        if (snapshot == nullptr) {
+            throw std::runtime_error("Delegate is empty");
+        }
+        return snapshot->value.InvokeAllParallel(executor, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief      依次调用存储的可调用对象，直到某个对象的返回值满足pred
+     * @param pred 判断函数，形如bool(const TRet &)，返回true时停止调用剩余的对象
+     * @param args 函数参数
+     * @return     最后一个被调用的可调用对象的返回值
+     */
+    template <typename TPred, typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, TRet>::type
+    InvokeUntil(TPred pred, Args... args) const
+    {
+        _ReadScope scope(*this);
+        _Snapshot *snapshot = scope.Get();
+        if (snapshot == nullptr) {
+            throw std::runtime_error("Delegate is empty");
+        }
+        return snapshot->value.InvokeUntil(std::move(pred), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief      依次调用存储的可调用对象，直到某个对象的返回值不满足pred
+     * @param pred 判断函数，形如bool(const TRet &)，返回false时停止调用剩余的对象
+     * @param args 函数参数
+     * @return     最后一个被调用的可调用对象的返回值
+     */
+    template <typename TPred, typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, TRet>::type
+    InvokeWhile(TPred pred, Args... args) const
+    {
+        _ReadScope scope(*this);
+        _Snapshot *snapshot = scope.Get();
+        if (snapshot == nullptr) {
+            throw std::runtime_error("Delegate is empty");
+        }
+        return snapshot->value.InvokeWhile(std::move(pred), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief      依次调用存储的可调用对象，直到flag被设置
+     * @param flag 取消标志，在调用每个对象之前检查，返回值被忽略
+     * @param args 函数参数
+     * @return     如果调用因取消而提前结束则返回true，否则返回false
+     */
+    bool InvokeUntil(const CancellationFlag &flag, Args... args) const
+    {
+        _ReadScope scope(*this);
+        _Snapshot *snapshot = scope.Get();
+        if (snapshot == nullptr) {
+            throw std::runtime_error("Delegate is empty");
+        }
+        return snapshot->value.InvokeUntil(flag, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief  判断当前委托是否等于nullptr
+     * @return 如果委托为空则返回true，否则返回false
+     */
+    bool operator==(std::nullptr_t) const noexcept
+    {
+        return _current.load(std::memory_order_acquire) == nullptr;
+    }
+
+    /**
+     * @brief  判断当前委托是否不等于nullptr
+     * @return 如果委托不为空则返回true，否则返回false
+     */
+    bool operator!=(std::nullptr_t) const noexcept
+    {
+        return _current.load(std::memory_order_acquire) != nullptr;
+    }
+
+    /**
+     * @brief  判断当前委托是否有效
+     * @return 如果委托不为空则返回true，否则返回false
+     */
+    operator bool() const noexcept
+    {
+        return _current.load(std::memory_order_acquire) != nullptr;
+    }
+
+    /**
+     * @brief 释放已不再被任何调用使用的旧快照
+     * @note  旧快照通常在后续修改时自动释放，修改停止后可调用此函数回收剩余的快照，
+     *        仍被正在进行的调用使用的快照会保留到下一次回收
+     */
+    void Reclaim()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _Reclaim();
+    }
+
+private:
+    /**
+     * @brief 内部函数，获取按缓存行对齐的读者计数器数组
+     */
+    _ReaderCounter *_Readers() const noexcept
+    {
+        uintptr_t address = reinterpret_cast<uintptr_t>(_readerStorage);
+        address           = (address + _CACHE_LINE - 1) & ~static_cast<uintptr_t>(_CACHE_LINE - 1);
+        return reinterpret_cast<_ReaderCounter *>(address);
+    }
+
+    /**
+     * @brief 内部函数，获取当前线程使用的读者计数器索引
+     */
+    static size_t _StripeIndex() noexcept
+    {
+        static std::atomic<size_t> next(0);
+        static thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed) % _STRIPES;
+        return index;
+    }
+
+    /**
+     * @brief 内部函数，在当前快照的副本上执行修改并发布新的快照
+     */
+    template <typename TFunc>
+    bool _Update(TFunc &&func)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _Snapshot *old = _current.load(std::memory_order_relaxed);
+        std::unique_ptr<_Snapshot> snapshot(new _Snapshot);
+        if (old != nullptr) {
+            snapshot->value = old->value;
+        }
+
+        bool result = func(snapshot->value);
+        if (!result) {
+            return false;
+        }
+
+        _current.store(snapshot->value == nullptr ? nullptr : snapshot.release(), std::memory_order_seq_cst);
+        if (old != nullptr) {
+            old->epoch = _epoch.load(std::memory_order_relaxed);
+            old->next  = _retired;
+            _retired   = old;
+        }
+        _Reclaim();
+        return true;
+    }
+
+    /**
+     * @brief 内部函数，若上一纪元登记的读者均已结束则推进纪元，调用者需持有_mutex
+     * @return 纪元是否被推进
+     */
+    bool _TryAdvanceEpoch() const noexcept
+    {
+        size_t epoch = _epoch.load(std::memory_order_relaxed);
+        size_t other = (epoch + 1) & 1;
+        _ReaderCounter *readers = _Readers();
+        for (size_t i = 0; i < _STRIPES; ++i) {
+            if (readers[i].value[other].load(std::memory_order_seq_cst) != 0) return false;
+        }
+        _epoch.store(epoch + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    /**
+     * @brief 内部函数，释放所有退役后纪元已推进两次的快照，调用者需持有_mutex
+     * @note  每个快照只等待可能读取到它的调用结束，持续的调用不会阻止更早的快照被释放
+     */
+    void _Reclaim() const noexcept
+    {
+        if (_retired == nullptr) {
+            return;
+        }
+        if (_TryAdvanceEpoch()) {
+            _TryAdvanceEpoch();
+        }
+
+        size_t epoch     = _epoch.load(std::memory_order_relaxed);
+        _Snapshot **link = &_retired;
+        while (*link != nullptr) {
+            _Snapshot *snapshot = *link;
+            if (epoch - snapshot->epoch >= 2) {
+                *link = snapshot->next;
+                delete snapshot;
+            } else {
+                link = &snapshot->next;
+            }
+        }
+    }
+};
+
+/*================================================================================*/
+
+/**
+ * @brief 固定容量的委托，最多存储N个可调用对象，所有对象都直接存储在委托内部，任何操作都不会产生堆分配
+ * @note  只接受满足CallableList::IsInlineStorable的可调用对象，超出容量时Add抛出std::length_error，TryAdd返回false。
+ *        调用期间的修改不影响正在进行的调用：被移除的对象在调用结束后才被销毁，在此之前仍占用容量；
+ *        新添加的对象从下一次调用开始生效
+ */
+template <size_t N, typename TRet, typename... Args>
+class StaticDelegate<TRet(Args...), N>
+{
+    static_assert(N > 0, "StaticDelegate capacity must be greater than 0");
+
+private:
+    using _ICallable = ICallable<TRet(Args...)>;
+    using _List      = CallableList<TRet(Args...)>;
+    using _Slot      = typename _List::_Slot;
+    using _Delegate  = Delegate<TRet(Args...)>;
+
+    template <typename T>
+    using _ArgRef = typename _List::template TArgRef<T>;
+
+    template <typename T>
+    using _CallableWrapper = typename _Delegate::template _CallableWrapper<T>;
+
+    template <typename T>
+    using _MemberFuncWrapper = typename _Delegate::template _MemberFuncWrapper<T>;
+
+    template <typename T>
+    using _ConstMemberFuncWrapper = typename _Delegate::template _ConstMemberFuncWrapper<T>;
+
+    /**
+     * @brief 存储可调用对象的存储槽
+     */
+    _Slot _slots[N];
+
+    /**
+     * @brief 对象在调用期间被移除时的版本号，为0时表示对象未被移除
+     */
+    size_t _removedAt[N];
+
+    /**
+     * @brief 已使用的存储槽数量，包括调用期间被移除的对象
+     */
+    size_t _count = 0;
+
+    /**
+     * @brief 未被移除的对象数量
+     */
+    size_t _live = 0;
+
+    /**
+     * @brief 调用期间移除对象的次数，所有调用结束后清零
+     */
+    size_t _version = 0;
+
+    /**
+     * @brief 正在进行的调用层数
+     */
+    mutable size_t _depth = 0;
+
+    /**
+     * @brief 调用作用域，记录调用开始时的存储槽数量和版本号，所有调用结束后销毁被移除的对象
+     */
+    class _InvokeScope
+    {
+        const StaticDelegate &_owner;
+        size_t _count;
+        size_t _version;
+
+    public:
+        explicit _InvokeScope(const StaticDelegate &owner) noexcept
+            : _owner(owner), _count(owner._count), _version(owner._version)
+        {
+            ++_owner._depth;
+        }
+        ~_InvokeScope()
+        {
+            if (--_owner._depth == 0 && _owner._version != 0) {
+                const_cast<StaticDelegate &>(_owner)._Compact();
+            }
+        }
+        size_t Count() const noexcept
+        {
+            return _count;
+        }
+        bool IsCallable(size_t index) const noexcept
+        {
+            size_t removedAt = _owner._removedAt[index];
+            return removedAt == 0 || removedAt > _version;
+        }
+    };
+
+public:
+    /**
+     * @brief 委托的容量
+     */
+    static constexpr size_t Capacity = N;
+
+    /**
+     * @brief 默认构造函数
+     */
+    StaticDelegate(std::nullptr_t = nullptr) noexcept
+    {
+    }
+
+    /**
+     * @brief 构造函数，接受一个函数指针
+     */
+    StaticDelegate(TRet (*func)(Args...))
+    {
+        Add(func);
+    }
+
+    /**
+     * @brief 构造函数，接受一个可调用对象
+     */
+    template <typename T, typename std::enable_if<!std::is_base_of<_ICallable, T>::value, int>::type = 0>
+    StaticDelegate(const T &callable)
+    {
+        Add(callable);
+    }
+
+    /**
+     * @brief 构造函数，接受一个右值可调用对象，该对象将被移动到委托中
+     */
+    template <typename T, typename std::enable_if<!std::is_reference<T>::value && !std::is_base_of<_ICallable, T>::value, int>::type = 0>
+    StaticDelegate(T &&callable)
+    {
+        Add(std::move(callable));
+    }
+
+    /**
+     * @brief 构造函数，接受一个成员函数指针
+     */
+    template <typename T>
+    StaticDelegate(T &obj, TRet (T::*func)(Args...))
+    {
+        Add(obj, func);
+    }
+
+    /**
+     * @brief 构造函数，接受一个常量成员函数指针
+     */
+    template <typename T>
+    StaticDelegate(const T &obj, TRet (T::*func)(Args...) const)
+    {
+        Add(obj, func);
+    }
+
+    /**
+     * @brief 拷贝构造函数
+     * @note  所有对象都存储在委托内部，新委托中的对象总是原对象的独立副本，与Delegate的共享语义不同
+     */
+    StaticDelegate(const StaticDelegate &other)
+    {
+        _Append(other);
+    }
+
+    /**
+     * @brief 移动构造函数
+     */
+    StaticDelegate(StaticDelegate &&other)
+    {
+        *this = std::move(other);
+    }
+
+    /**
+     * @brief 拷贝赋值运算符
+     * @throw std::length_error 如果在调用期间赋值且容量不足
+     */
+    StaticDelegate &operator=(const StaticDelegate &other)
+    {
+        if (this != &other) {
+            Clear();
+            _Append(other);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief 移动赋值运算符
+     * @throw std::length_error 如果在调用期间赋值且容量不足
+     */
+    StaticDelegate &operator=(StaticDelegate &&other)
+    {
+        if (this == &other) {
+            return *this;
+        }
+
+        Clear();
+
+        // 正在调用的委托需要保留其内容直到调用结束，此时退化为复制
+        if (other._depth != 0) {
+            _Append(other);
+            other.Clear();
+            return *this;
+        }
+
+        for (size_t i = 0; i < other._count; ++i) {
+            _CheckCapacity();
+            _slots[_count].MoveFrom(other._slots[i]);
+            _removedAt[_count] = 0;
+            ++_count;
+            ++_live;
+        }
+        other._count = 0;
+        other._live  = 0;
+        return *this;
+    }
+
+    /**
+     * @brief 获取当前存储的可调用对象数量
+     */
+    size_t Count() const noexcept
+    {
+        return _live;
+    }
+
+    /**
+     * @brief 添加一个函数指针到委托中
+     * @throw std::length_error 如果容量不足
+     */
+    void Add(TRet (*func)(Args...))
+    {
+        if (func != nullptr) {
+            _Emplace<_CallableWrapper<decltype(func)>>(func);
+        }
+    }
+
+    /**
+     * @brief 添加一个可调用对象到委托中
+     * @throw std::length_error 如果容量不足
+     */
+    template <typename T>
+    typename std::enable_if<!std::is_base_of<_ICallable, T>::value, void>::type
+    Add(const T &callable)
+    {
+        _Emplace<_CallableWrapper<T>>(callable);
+    }
+
+    /**
+     * @brief 添加一个右值可调用对象到委托中，该对象将被移动到委托中
+     * @throw std::length_error 如果容量不足
+     */
+    template <typename T>
+    typename std::enable_if<!std::is_reference<T>::value && !std::is_base_of<_ICallable, T>::value, void>::type
+    Add(T &&callable)
+    {
+        _Emplace<_CallableWrapper<T>>(std::move(callable));
+    }
+
+    /**
+     * @brief 添加一个成员函数指针到委托中
+     * @throw std::length_error 如果容量不足
+     */
+    template <typename T>
+    void Add(T &obj, TRet (T::*func)(Args...))
+    {
+        _Emplace<_MemberFuncWrapper<T>>(obj, func);
+    }
+
+    /**
+     * @brief 添加一个常量成员函数指针到委托中
+     * @throw std::length_error 如果容量不足
+     */
+    template <typename T>
+    void Add(const T &obj, TRet (T::*func)(Args...) const)
+    {
+        _Emplace<_ConstMemberFuncWrapper<T>>(obj, func);
+    }
+
+    /**
+     * @brief  尝试添加一个函数指针到委托中，容量不足时不抛出异常
+     * @return 如果容量不足则返回false，否则返回true（func为nullptr时不添加任何对象）
+     */
+    bool TryAdd(TRet (*func)(Args...))
+    {
+        return func == nullptr || _TryEmplace<_CallableWrapper<decltype(func)>>(func);
+    }
+
+    /**
+     * @brief  尝试添加一个可调用对象到委托中，容量不足时不抛出异常
+     * @return 如果容量不足则返回false，否则返回true
+     */
+    template <typename T>
+    typename std::enable_if<!std::is_base_of<_ICallable, T>::value, bool>::type
+    TryAdd(const T &callable)
+    {
+        return _TryEmplace<_CallableWrapper<T>>(callable);
+    }
+
+    /**
+     * @brief  尝试添加一个右值可调用对象到委托中，容量不足时不抛出异常，此时callable不会被移动
+     * @return 如果容量不足则返回false，否则返回true
+     */
+    template <typename T>
+    typename std::enable_if<!std::is_reference<T>::value && !std::is_base_of<_ICallable, T>::value, bool>::type
+    TryAdd(T &&callable)
+    {
+        return _TryEmplace<_CallableWrapper<T>>(std::move(callable));
+    }
+
+    /**
+     * @brief  尝试添加一个成员函数指针到委托中，容量不足时不抛出异常
+     * @return 如果容量不足则返回false，否则返回true
+     */
+    template <typename T>
+    bool TryAdd(T &obj, TRet (T::*func)(Args...))
+    {
+        return _TryEmplace<_MemberFuncWrapper<T>>(obj, func);
+    }
+
+    /**
+     * @brief  尝试添加一个常量成员函数指针到委托中，容量不足时不抛出异常
+     * @return 如果容量不足则返回false，否则返回true
+     */
+    template <typename T>
+    bool TryAdd(const T &obj, TRet (T::*func)(Args...) const)
+    {
+        return _TryEmplace<_ConstMemberFuncWrapper<T>>(obj, func);
+    }
+
+    /**
+     * @brief 清空委托中的所有可调用对象
+     */
+    void Clear() noexcept
+    {
+        if (_depth != 0) {
+            for (size_t i = 0; i < _count; ++i) {
+                if (_removedAt[i] == 0) _removedAt[i] = ++_version;
+            }
+            _live = 0;
+            return;
+        }
+        for (size_t i = 0; i < _count; ++i) {
+            _slots[i].Reset();
+        }
+        _count = 0;
+        _live  = 0;
+    }
+
+    /**
+     * @brief  移除一个函数指针
+     * @return 如果成功移除则返回true，否则返回false
+     * @note   按照添加顺序从后向前查找，找到第一个匹配的函数指针并移除
+     */
+    bool Remove(TRet (*func)(Args...))
+    {
+        if (func == nullptr) {
+            return false;
+        }
+        return _Remove(_CallableWrapper<decltype(func)>(func));
+    }
+
+    /**
+     * @brief  移除一个可调用对象
+     * @return 如果成功移除则返回true，否则返回false
+     * @note   按照添加顺序从后向前查找，找到第一个匹配的可调用对象并移除
+     */
+    template <typename T>
+    typename std::enable_if<!std::is_base_of<_ICallable, T>::value, bool>::type
+    Remove(const T &callable)
+    {
+        return _Remove(_CallableWrapper<T>(callable));
+    }
+
+    /**
+     * @brief  移除一个成员函数指针
+     * @return 如果成功移除则返回true，否则返回false
+     * @note   按照添加顺序从后向前查找，找到第一个匹配的可调用对象并移除
+     */
+    template <typename T>
+    bool Remove(T &obj, TRet (T::*func)(Args...))
+    {
+        return _Remove(_MemberFuncWrapper<T>(obj, func));
+    }
+
+    /**
+     * @brief  移除一个常量成员函数指针
+     * @return 如果成功移除则返回true，否则返回false
+     * @note   按照添加顺序从后向前查找，找到第一个匹配的可调用对象并移除
+     */
+    template <typename T>
+    bool Remove(const T &obj, TRet (T::*func)(Args...) const)
+    {
+        return _Remove(_ConstMemberFuncWrapper<T>(obj, func));
+    }
 
+    /**
+     * @brief 添加一个可调用对象
+     * @note  该函数调用Add函数
+     */
     template <typename T>
-    using _CallableWrapper = _CallableWrapperImpl<typename std::decay<T>::type>;
+    StaticDelegate &operator+=(T &&callable)
+    {
+        Add(std::forward<T>(callable));
+        return *this;
+    }
 
+    /**
+     * @brief 移除一个可调用对象
+     * @note  该函数调用Remove函数
+     */
     template <typename T>
-    class _MemberFuncWrapper final : public _ICallable
+    StaticDelegate &operator-=(T &&callable)
     {
-        T *obj;
-        TRet (T::*func)(Args...);
+        Remove(std::forward<T>(callable));
+        return *this;
+    }
 
-    public:
-        _MemberFuncWrapper(T &obj, TRet (T::*func)(Args...))
-            : obj(&obj), func(func)
-        {
-        }
-        TRet Invoke(Args... args) const override
-        {
-            return (obj->*func)(std::forward<Args>(args)...);
-        }
-        _ICallable *Clone() const override
-        {
-            return new _MemberFuncWrapper(*obj, func);
-        }
-        virtual std::type_index GetType() const override
-        {
-            return typeid(func);
-        }
-        bool Equals(const _ICallable &other) const override
-        {
-            if (this == &other) {
-                return true;
-            }
-            if (GetType() != other.GetType()) {
-                return false;
-            }
-            const auto &otherWrapper = static_cast<const _MemberFuncWrapper &>(other);
-            return obj == otherWrapper.obj && func == otherWrapper.func;
-        }
-    };
+    /**
+     * @brief      调用委托，执行所有存储的可调用对象
+     * @param args 函数参数
+     * @return     最后一个可调用对象的返回值
+     * @throw      std::runtime_error 如果委托为空
+     */
+    TRet operator()(Args... args) const
+    {
+        return _InvokeImpl(true, args...);
+    }
 
-    template <typename T>
-    class _ConstMemberFuncWrapper final : public _ICallable
+    /**
+     * @brief      调用委托，执行所有存储的可调用对象
+     * @param args 函数参数
+     * @return     最后一个可调用对象的返回值
+     * @throw      std::runtime_error 如果委托为空
+     */
+    TRet Invoke(Args... args) const
     {
-        const T *obj;
-        TRet (T::*func)(Args...) const;
+        return _InvokeImpl(true, args...);
+    }
 
-    public:
-        _ConstMemberFuncWrapper(const T &obj, TRet (T::*func)(Args...) const)
-            : obj(&obj), func(func)
-        {
-        }
-        TRet Invoke(Args... args) const override
-        {
-            return (obj->*func)(std::forward<Args>(args)...);
+    /**
+     * @brief      调用所有存储的可调用对象，并返回它们的结果
+     * @param args 函数参数
+     * @return     返回一个包含所有可调用对象返回值的vector
+     * @note       返回的vector本身需要分配内存
+     */
+    template <typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, std::vector<U>>::type
+    InvokeAll(Args... args) const
+    {
+        std::vector<U> results;
+        if (_live == 0) {
+            _ThrowEmptyDelegateError();
         }
-        _ICallable *Clone() const override
-        {
-            return new _ConstMemberFuncWrapper(*obj, func);
+        results.reserve(_live);
+        auto sink = [&results](U &&result) { results.emplace_back(std::forward<U>(result)); };
+        _InvokeEach(sink, args...);
+        return results;
+    }
+
+    /**
+     * @brief      调用所有存储的可调用对象，并将它们的结果依次写入输出迭代器
+     * @param out  输出迭代器，调用者需保证其能够容纳所有结果
+     * @param args 函数参数
+     * @return     写入最后一个结果之后的输出迭代器
+     * @throw      std::runtime_error 如果委托为空
+     */
+    template <typename TOutputIt, typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, TOutputIt>::type
+    InvokeAll(TOutputIt out, Args... args) const
+    {
+        auto sink = [&out](U &&result) { *out = std::forward<U>(result); ++out; };
+        _InvokeEach(sink, args...);
+        return out;
+    }
+
+    /**
+     * @brief      调用所有存储的可调用对象，并使用op依次合并它们的结果
+     * @param init 初始值
+     * @param op   合并函数，形如TAcc(TAcc, TRet)，依次接收当前的累积值和每个可调用对象的返回值
+     * @param args 函数参数
+     * @return     合并后的结果
+     * @throw      std::runtime_error 如果委托为空
+     */
+    template <typename TAcc, typename TOp, typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, TAcc>::type
+    InvokeReduce(TAcc init, TOp op, Args... args) const
+    {
+        auto sink = [&init, &op](U &&result) { init = op(std::move(init), std::forward<U>(result)); };
+        _InvokeEach(sink, args...);
+        return init;
+    }
+
+    /**
+     * @brief      依次调用存储的可调用对象，直到某个对象的返回值满足pred
+     * @param pred 判断函数，形如bool(const TRet &)，返回true时停止调用剩余的对象
+     * @param args 函数参数
+     * @return     最后一个被调用的可调用对象的返回值
+     * @throw      std::runtime_error 如果委托为空
+     */
+    template <typename TPred, typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, TRet>::type
+    InvokeUntil(TPred pred, Args... args) const
+    {
+        auto cond = [&pred](const U &result) -> bool { return !pred(result); };
+        return _InvokeWhileImpl(cond, args...);
+    }
+
+    /**
+     * @brief      依次调用存储的可调用对象，直到某个对象的返回值不满足pred
+     * @param pred 判断函数，形如bool(const TRet &)，返回false时停止调用剩余的对象
+     * @param args 函数参数
+     * @return     最后一个被调用的可调用对象的返回值
+     * @throw      std::runtime_error 如果委托为空
+     */
+    template <typename TPred, typename U = TRet>
+    typename std::enable_if<!std::is_void<U>::value, TRet>::type
+    InvokeWhile(TPred pred, Args... args) const
+    {
+        auto cond = [&pred](const U &result) -> bool { return static_cast<bool>(pred(result)); };
+        return _InvokeWhileImpl(cond, args...);
+    }
+
+    /**
+     * @brief      依次调用存储的可调用对象，直到flag被设置
+     * @param flag 取消标志，在调用每个对象之前检查，返回值被忽略
+     * @param args 函数参数
+     * @return     如果调用因取消而提前结束则返回true，否则返回false
+     * @throw      std::runtime_error 如果委托为空
+     */
+    bool InvokeUntil(const CancellationFlag &flag, Args... args) const
+    {
+        if (_live == 0) {
+            _ThrowEmptyDelegateError();
         }
-        virtual std::type_index GetType() const override
-        {
-            return typeid(func);
+        _InvokeScope scope(*this);
+        size_t last = scope.Count() - 1;
+        while (!scope.IsCallable(last)) {
+            --last;
         }
-        bool Equals(const _ICallable &other) const override
-        {
-            if (this == &other) {
-                return true;
-            }
-            if (GetType() != other.GetType()) {
-                return false;
-            }
-            const auto &otherWrapper = static_cast<const _ConstMemberFuncWrapper &>(other);
-            return obj == otherWrapper.obj && func == otherWrapper.func;
+        for (size_t i = 0; i <= last; ++i) {
+            if (flag.IsCancelled()) return true;
+            if (scope.IsCallable(i)) _slots[i].Invoke(i == last, args...);
         }
-    };
+        return false;
+    }
 
-private:
     /**
-     * @brief 内部存储可调用对象的容器
+     * @brief  判断当前委托是否等于nullptr
+     * @return 如果委托为空则返回true，否则返回false
      */
-    CallableList<TRet(Args...)> _data;
+    bool operator==(std::nullptr_t) const noexcept
+    {
+        return _live == 0;
+    }
 
-public:
     /**
-     * @brief 默认构造函数
+     * @brief  判断当前委托是否不等于nullptr
+     * @return 如果委托不为空则返回true，否则返回false
      */
-    Delegate(std::nullptr_t = nullptr)
+    bool operator!=(std::nullptr_t) const noexcept
     {
+        return _live != 0;
     }
 
     /**
-     * @brief 构造函数，接受一个可调用对象
+     * @brief  判断当前委托是否有效
+     * @return 如果委托不为空则返回true，否则返回false
      */
-    Delegate(const ICallable<TRet(Args...)> &callable)
+    operator bool() const noexcept
     {
-        Add(callable);
+        return _live != 0;
     }
 
+private:
     /**
-     * @brief 构造函数，接受一个函数指针
+     * @brief 内部函数，容量不足时抛出异常
      */
-    Delegate(TRet (*func)(Args...))
+    void _CheckCapacity() const
     {
-        Add(func);
+        if (_count == N) {
+            throw std::length_error("StaticDelegate capacity exceeded");
+        }
     }
 
     /**
-     * @brief 构造函数，接受一个可调用对象
+     * @brief 内部函数，在末尾的存储槽中构造一个可调用对象，容量不足时抛出异常
      */
-    template <typename T, typename std::enable_if<!std::is_base_of<_ICallable, T>::value, int>::type = 0>
-    Delegate(const T &callable)
+    template <typename TWrapper, typename... CtorArgs>
+    void _Emplace(CtorArgs &&...args)
     {
-        Add(callable);
+        _CheckCapacity();
+        _TryEmplace<TWrapper>(std::forward<CtorArgs>(args)...);
     }
 
     /**
-     * @brief 构造函数，接受一个成员函数指针
+     * @brief  内部函数，在末尾的存储槽中构造一个可调用对象
+     * @return 如果容量不足则不构造对象并返回false，否则返回true
      */
-    template <typename T>
-    Delegate(T &obj, TRet (T::*func)(Args...))
+    template <typename TWrapper, typename... CtorArgs>
+    bool _TryEmplace(CtorArgs &&...args)
     {
-        Add(obj, func);
+        static_assert(_List::template IsCopyable<TWrapper>::value,
+                      "Callable must be copy constructible for StaticDelegate");
+        static_assert(_List::template IsInlineStorable<TWrapper>::value,
+                      "Callable is too large for StaticDelegate, consider increasing DELEGATE_INLINE_SIZE");
+        if (_count == N) {
+            return false;
+        }
+        _slots[_count].template EmplaceInline<TWrapper>(std::forward<CtorArgs>(args)...);
+        _removedAt[_count] = 0;
+        ++_count;
+        ++_live;
+        return true;
     }
 
     /**
-     * @brief 构造函数，接受一个常量成员函数指针
+     * @brief 内部函数，将另一个委托中未被移除的可调用对象复制到末尾
      */
-    template <typename T>
-    Delegate(const T &obj, TRet (T::*func)(Args...) const)
+    void _Append(const StaticDelegate &other)
     {
-        Add(obj, func);
+        for (size_t i = 0; i < other._count; ++i) {
+            if (other._removedAt[i] != 0) {
+                continue;
+            }
+            _CheckCapacity();
+            _slots[_count].CopyFrom(other._slots[i]);
+            _removedAt[_count] = 0;
+            ++_count;
+            ++_live;
+        }
     }
 
     /**
-     * @brief 拷贝构造函数
+     * @brief 内部函数，用于从后向前查找并移除一个可调用对象
      */
-    Delegate(const Delegate &other)
+    bool _Remove(const _ICallable &callable)
     {
-        for (size_t i = 0; i < other._data.Count(); ++i) {
-            _data.Add(other._data[i]->Clone());
+        for (size_t i = _count; i > 0; --i) {
+            if (_removedAt[i - 1] == 0 && _slots[i - 1].Get()->Equals(callable)) {
+                _RemoveAt(i - 1);
+                return true;
+            }
         }
+        return false;
     }
 
     /**
-     * @brief 移动构造函数
+     * @brief 内部函数，移除指定位置处的对象，调用期间只做标记
      */
-    Delegate(Delegate &&other) noexcept
-        : _data(std::move(other._data))
+    void _RemoveAt(size_t index) noexcept
     {
+        --_live;
+        if (_depth != 0) {
+            _removedAt[index] = ++_version;
+            return;
+        }
+        for (size_t i = index; i + 1 < _count; ++i) {
+            _slots[i].MoveFrom(_slots[i + 1]);
+        }
+        _slots[--_count].Reset();
     }
 
     /**
-     * @brief 拷贝赋值运算符
+     * @brief 内部函数，销毁调用期间被移除的对象
      */
-    Delegate &operator=(const Delegate &other)
+    void _Compact() noexcept
     {
-        if (this == &other) {
-            return *this;
-        }
-        _data.Clear();
-        for (size_t i = 0; i < other._data.Count(); ++i) {
-            _data.Add(other._data[i]->Clone());
+        size_t count = 0;
+        for (size_t i = 0; i < _count; ++i) {
+            if (_removedAt[i] != 0) {
+                _slots[i].Reset();
+            } else {
+                if (i != count) _slots[count].MoveFrom(_slots[i]);
+                _removedAt[count++] = 0;
+            }
         }
-        return *this;
+        _count   = count;
+        _version = 0;
     }
 
     /**
-     * @brief 移动赋值运算符
+     * @brief 内部函数，调用空委托时抛出异常
      */
-    Delegate &operator=(Delegate &&other) noexcept
+    [[noreturn]] void _ThrowEmptyDelegateError() const
     {
-        if (this != &other) {
-            _data = std::move(other._data);
+        throw std::runtime_error("Delegate is empty");
+    }
+
+    /**
+     * @brief 内部函数，调用所有存储的可调用对象，并将每个返回值依次传递给sink
+     */
+    template <typename TSink>
+    void _InvokeEach(TSink &sink, _ArgRef<Args>... args) const
+    {
+        if (_live == 0) {
+            _ThrowEmptyDelegateError();
+        }
+        _InvokeScope scope(*this);
+        size_t last = scope.Count() - 1;
+        while (!scope.IsCallable(last)) {
+            --last;
+        }
+        for (size_t i = 0; i <= last; ++i) {
+            if (scope.IsCallable(i)) sink(_slots[i].Invoke(i == last, args...));
         }
-        return *this;
     }
 
     /**
-     * @brief 添加一个可调用对象到委托中
+     * @brief 内部函数，依次调用存储的可调用对象，直到某个对象的返回值使cond返回false
      */
-    void Add(const ICallable<TRet(Args...)> &callable)
+    template <typename TCond>
+    TRet _InvokeWhileImpl(TCond &cond, _ArgRef<Args>... args) const
     {
-        // 当添加的可调用对象与当前委托类型相同时（针对单播委托进行优化）：
-        // - 若委托内容为空，则直接返回
-        // - 若委托内容只有一个元素，则克隆该元素并添加到当前委托中
-        // - 否则，直接添加该可调用对象的克隆
-        if (callable.GetType() == GetType()) {
-            auto &delegate = static_cast<const Delegate &>(callable);
-            if (delegate._data.IsEmpty()) {
-                return;
-            } else if (delegate._data.Count() == 1) {
-                _data.Add(delegate._data[0]->Clone());
-                return;
-            }
+        if (_live == 0) {
+            _ThrowEmptyDelegateError();
+        }
+        _InvokeScope scope(*this);
+        size_t last = scope.Count() - 1;
+        while (!scope.IsCallable(last)) {
+            --last;
+        }
+        for (size_t i = 0; i < last; ++i) {
+            if (!scope.IsCallable(i)) continue;
+            TRet result = _slots[i].Invoke(false, args...);
+            if (!cond(result)) return result;
         }
-        _data.Add(callable.Clone());
+        return _slots[last].Invoke(true, args...);
     }
 
     /**
-     * @brief 添加一个函数指针到委托中
+     * @brief 内部函数，Invoke和operator()的实现
+     * @note  最后一个之外的对象以共享的形式接收参数，forward为true时最后一个对象接收转发（移动）的参数
      */
-    void Add(TRet (*func)(Args...))
+    TRet _InvokeImpl(bool forward, _ArgRef<Args>... args) const
     {
-        if (func != nullptr) {
-            _data.Add(new _CallableWrapper<decltype(func)>(func));
+        if (_live == 0) {
+            _ThrowEmptyDelegateError();
+        }
+        _InvokeScope scope(*this);
+        size_t last = scope.Count() - 1;
+        while (!scope.IsCallable(last)) {
+            --last;
         }
+        for (size_t i = 0; i < last; ++i) {
+            if (scope.IsCallable(i)) _slots[i].Invoke(false, args...);
+        }
+        return _slots[last].Invoke(forward, args...);
     }
+};
+
+#if !defined(__cpp_inline_variables)
+template <size_t N, typename TRet, typename... Args>
+constexpr size_t StaticDelegate<TRet(Args...), N>::Capacity;
+#endif
+
+/*================================================================================*/
 
+/**
+ * @brief 订阅的RAII包装，析构时通过令牌移除对应的可调用对象
+ * @note  适用于Delegate和ConcurrentDelegate，调用者需保证委托的生命周期长于该对象
+ */
+class ScopedSubscription
+{
     /**
-     * @brief 添加一个可调用对象到委托中
+     * @brief 订阅所属的委托
      */
-    template <typename T>
-    typename std::enable_if<!std::is_base_of<_ICallable, T>::value, void>::type
-    Add(const T &callable)
+    void *_delegate = nullptr;
+
+    /**
+     * @brief 移除订阅的函数
+     */
+    bool (*_unsubscribe)(void *, SubscriptionToken) = nullptr;
+
+    /**
+     * @brief 订阅令牌
+     */
+    SubscriptionToken _token;
+
+    /**
+     * @brief 内部函数，通过令牌移除指定委托中的可调用对象
+     */
+    template <typename TDelegate>
+    static bool _Unsubscribe(void *delegate, SubscriptionToken token)
     {
-        _data.Add(new _CallableWrapper<T>(callable));
+        return static_cast<TDelegate *>(delegate)->Unsubscribe(token);
     }
 
+public:
     /**
-     * @brief 添加一个成员函数指针到委托中
+     * @brief 默认构造函数，不持有任何订阅
      */
-    template <typename T>
-    void Add(T &obj, TRet (T::*func)(Args...))
+    ScopedSubscription() noexcept
     {
-        _data.Add(new _MemberFuncWrapper<T>(obj, func));
     }
 
     /**
-     * @brief 添加一个常量成员函数指针到委托中
+     * @brief 构造函数，接管委托中令牌对应的订阅
      */
-    template <typename T>
-    void Add(const T &obj, TRet (T::*func)(Args...) const)
+    template <typename TDelegate>
+    ScopedSubscription(TDelegate &delegate, SubscriptionToken token) noexcept
+        : _delegate(&delegate), _unsubscribe(&_Unsubscribe<TDelegate>), _token(token)
     {
-        _data.Add(new _ConstMemberFuncWrapper<T>(obj, func));
     }
 
+    ScopedSubscription(const ScopedSubscription &)            = delete;
+    ScopedSubscription &operator=(const ScopedSubscription &) = delete;
+
     /**
-     * @brief 清空委托中的所有可调用对象
+     * @brief 移动构造函数
      */
-    void Clear()
+    ScopedSubscription(ScopedSubscription &&other) noexcept
+        : _delegate(other._delegate), _unsubscribe(other._unsubscribe), _token(other.Release())
     {
-        _data.Clear();
     }
 
     /**
-     * @brief  移除一个可调用对象
-     * @return 如果成功移除则返回true，否则返回false
-     * @note   按照添加顺序从后向前查找，找到第一个匹配的可调用对象并移除
+     * @brief 移动赋值运算符，当前持有的订阅将被移除
      */
-    bool Remove(const ICallable<TRet(Args...)> &callable)
+    ScopedSubscription &operator=(ScopedSubscription &&other)
     {
-        // 当移除的可调用对象与当前委托类型相同时（与Add逻辑相对应）：
-        // - 若委托内容为空，则直接返回false
-        // - 若委托内容只有一个元素，则尝试移除该元素
-        // - 否则，直接调用_Remove函数进行移除
-        if (callable.GetType() == GetType()) {
-            auto &delegate = static_cast<const Delegate &>(callable);
-            if (delegate._data.IsEmpty()) {
-                return false;
-            } else if (delegate._data.Count() == 1) {
-                return _Remove(*delegate._data[0]);
-            }
+        if (this != &other) {
+            Reset();
+            _delegate    = other._delegate;
+            _unsubscribe = other._unsubscribe;
+            _token       = other.Release();
         }
-        return _Remove(callable);
+        return *this;
     }
 
     /**
-     * @brief  移除一个函数指针
-     * @return 如果成功移除则返回true，否则返回false
-     * @note   按照添加顺序从后向前查找，找到第一个匹配的函数指针并移除
+     * @brief 析构函数，移除持有的订阅
      */
-    bool Remove(TRet (*func)(Args...))
+    ~ScopedSubscription()
     {
-        if (func == nullptr) {
-            return false;
-        }
-        return _Remove(_CallableWrapper<decltype(func)>(func));
+        Reset();
     }
 
     /**
-     * @brief  移除一个可调用对象
-     * @return 如果成功移除则返回true，否则返回false
-     * @note   按照添加顺序从后向前查找，找到第一个匹配的可调用对象并移除
+     * @brief 获取持有的订阅令牌
      */
-    template <typename T>
-    typename std::enable_if<!std::is_base_of<_ICallable, T>::value, bool>::type
-    Remove(const T &callable)
+    SubscriptionToken GetToken() const noexcept
     {
-        return _Remove(_CallableWrapper<T>(callable));
+        return _token;
     }
 
     /**
-     * @brief  移除一个成员函数指针
-     * @return 如果成功移除则返回true，否则返回false
-     * @note   按照添加顺序从后向前查找，找到第一个匹配的可调用对象并移除
+     * @brief  放弃持有的订阅而不移除它
+     * @return 原先持有的订阅令牌
      */
-    template <typename T>
-    bool Remove(T &obj, TRet (T::*func)(Args...))
+    SubscriptionToken Release() noexcept
     {
-        return _Remove(_MemberFuncWrapper<T>(obj, func));
+        SubscriptionToken token = _token;
+        _token                  = SubscriptionToken();
+        return token;
     }
 
     /**
-     * @brief  移除一个常量成员函数指针
-     * @return 如果成功移除则返回true，否则返回false
-     * @note   按照添加顺序从后向前查找，找到第一个匹配的可调用对象并移除
+     * @brief 立即移除持有的订阅
      */
-    template <typename T>
-    bool Remove(const T &obj, TRet (T::*func)(Args...) const)
+    void Reset()
     {
-        return _Remove(_ConstMemberFuncWrapper<T>(obj, func));
+        if (_token) {
+            _unsubscribe(_delegate, Release());
+        }
     }
 
     /**
-     * @brief      调用委托，执行所有存储的可调用对象
-     * @param args 函数参数
-     * @return     最后一个可调用对象的返回值
-     * @throw      std::runtime_error 如果委托为空
+     * @brief  判断是否持有订阅
+     * @return 如果持有订阅则返回true，否则返回false
      */
-    TRet operator()(Args... args) const
+    explicit operator bool() const noexcept
     {
-        return _InvokeImpl(std::forward<Args>(args)...);
+        return static_cast<bool>(_token);
     }
+};
+
+/*================================================================================*/
+
+/**
+ * @brief 延迟调用的委托，生产者将调用请求放入预分配的环形缓冲区，由Flush批量调用目标委托
+ * @note  Post和PostCoalesced可以在任意线程调用，Flush应由同一个消费者线程调用；调用目标委托时不持有锁，
+ *        处理函数中可以继续提交请求，这些请求在下一次Flush时处理。目标委托为空时取出的请求被直接丢弃，
+ *        调用者需保证目标委托的生命周期长于该对象
+ */
+template <typename TRet, typename... Args>
+class DeferredDelegate<TRet(Args...)>
+{
+    using _Delegate = Delegate<TRet(Args...)>;
+
+    template <typename T>
+    using _StoredArg = typename _Delegate::template _StoredArg<T>;
+
+    using _Args = std::tuple<_StoredArg<Args>...>;
 
     /**
-     * @brief       判断当前委托是否等于另一个委托
-     * @param other 另一个委托
-     * @return      如果相等则返回true，否则返回false
+     * @brief 环形缓冲区中的一个调用请求
      */
-    bool operator==(const Delegate &other) const
-    {
-        return Equals(other);
-    }
+    struct _Entry {
+        alignas(_Args) unsigned char args[sizeof(_Args)]; // 保存的参数
+        size_t key;                                       // 合并请求的键
+        bool coalesced;                                   // 是否为可合并的请求
+    };
 
     /**
-     * @brief       判断当前委托是否不等于另一个委托
-     * @param other 另一个委托
-     * @return      如果不相等则返回true，否则返回false
+     * @brief 键表中的条目，pos为SIZE_MAX时表示空位
      */
-    bool operator!=(const Delegate &other) const
-    {
-        return !Equals(other);
-    }
+    struct _KeyEntry {
+        size_t key;
+        size_t pos;
+    };
 
     /**
-     * @brief  判断当前委托是否等于nullptr
-     * @return 如果委托为空则返回true，否则返回false
+     * @brief 目标委托
      */
-    bool operator==(std::nullptr_t) const noexcept
-    {
-        return _data.IsEmpty();
-    }
+    _Delegate *_target;
 
     /**
-     * @brief  判断当前委托是否不等于nullptr
-     * @return 如果委托不为空则返回true，否则返回false
+     * @brief 环形缓冲区
      */
-    bool operator!=(std::nullptr_t) const noexcept
-    {
-        return !_data.IsEmpty();
-    }
+    std::unique_ptr<_Entry[]> _entries;
 
     /**
-     * @brief  判断当前委托是否有效
-     * @return 如果委托不为空则返回true，否则返回false
+     * @brief 记录每个键对应的待处理请求位置的哈希表，采用线性探测
      */
-    operator bool() const noexcept
-    {
-        return !_data.IsEmpty();
-    }
+    std::unique_ptr<_KeyEntry[]> _keys;
 
     /**
-     * @brief 添加一个可调用对象到委托中
-     * @note  该函数调用Add函数
+     * @brief 环形缓冲区的容量
      */
-    Delegate &operator+=(const ICallable<TRet(Args...)> &callable)
-    {
-        Add(callable);
-        return *this;
-    }
+    size_t _capacity;
 
     /**
-     * @brief 添加一个函数指针到委托中
-     * @note  该函数调用Add函数
+     * @brief 键表容量减1，键表容量为2的幂
      */
-    Delegate &operator+=(TRet (*func)(Args...))
-    {
-        Add(func);
-        return *this;
-    }
+    size_t _keyMask;
 
     /**
-     * @brief 添加一个可调用对象到委托中
-     * @note  该函数调用Add函数
+     * @brief 第一个待处理请求的位置
      */
-    template <typename T>
-    typename std::enable_if<!std::is_base_of<_ICallable, T>::value, Delegate &>::type
-    operator+=(const T &callable)
-    {
-        Add(callable);
-        return *this;
-    }
+    size_t _head = 0;
 
     /**
-     * @brief 移除一个可调用对象
-     * @note  该函数调用Remove函数
+     * @brief 待处理请求的数量
      */
-    Delegate &operator-=(const ICallable<TRet(Args...)> &callable)
+    size_t _size = 0;
+
+    /**
+     * @brief 保护缓冲区和键表的互斥量
+     */
+    mutable std::mutex _mutex;
+
+public:
+    /**
+     * @brief          构造函数，预先分配所有需要的内存，之后提交请求不会产生堆分配
+     * @param target   目标委托
+     * @param capacity 最多可以同时保存的待处理请求数量
+     * @throw          std::invalid_argument 如果capacity为0
+     */
+    DeferredDelegate(_Delegate &target, size_t capacity)
+        : _target(&target), _capacity(capacity)
     {
-        Remove(callable);
-        return *this;
+        if (capacity == 0) {
+            throw std::invalid_argument("DeferredDelegate capacity must be greater than 0");
+        }
+        size_t keyCapacity = 8;
+        while (keyCapacity < capacity * 2) keyCapacity *= 2;
+        _entries.reset(new _Entry[capacity]);
+        _keys.reset(new _KeyEntry[keyCapacity]);
+        _keyMask = keyCapacity - 1;
+        for (size_t i = 0; i < keyCapacity; ++i) {
+            _keys[i].pos = SIZE_MAX;
+        }
     }
 
     /**
-     * @brief 移除一个函数指针
-     * @note  该函数调用Remove函数
+     * @brief 析构函数，丢弃所有未处理的请求
      */
-    Delegate &operator-=(TRet (*func)(Args...))
+    ~DeferredDelegate()
     {
-        Remove(func);
-        return *this;
+        Clear();
     }
 
+    DeferredDelegate(const DeferredDelegate &)            = delete;
+    DeferredDelegate &operator=(const DeferredDelegate &) = delete;
+
     /**
-     * @brief 移除一个可调用对象
-     * @note  该函数调用Remove函数
+     * @brief  获取缓冲区的容量
      */
-    template <typename T>
-    typename std::enable_if<!std::is_base_of<_ICallable, T>::value, Delegate &>::type
-    operator-=(const T &callable)
+    size_t Capacity() const noexcept
     {
-        Remove(callable);
-        return *this;
+        return _capacity;
     }
 
     /**
-     * @brief      调用委托，执行所有存储的可调用对象
-     * @param args 函数参数
-     * @return     最后一个可调用对象的返回值
-     * @throw      std::runtime_error 如果委托为空
+     * @brief  获取待处理请求的数量
      */
-    virtual TRet Invoke(Args... args) const override
+    size_t Count() const
     {
-        return _InvokeImpl(std::forward<Args>(args)...);
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _size;
     }
 
     /**
-     * @brief  克隆当前委托
-     * @return 返回一个新的Delegate对象，包含相同的可调用对象
+     * @brief  判断是否没有待处理的请求
      */
-    virtual ICallable<TRet(Args...)> *Clone() const override
+    bool IsEmpty() const
     {
-        return new Delegate(*this);
+        return Count() == 0;
     }
 
     /**
-     * @brief  获取当前委托的类型信息
-     * @return 返回typeid(Delegate<TRet(Args...)>)
+     * @brief      提交一个调用请求
+     * @param args 函数参数，非常量左值引用参数保存引用，其余参数保存副本
+     * @return     成功提交返回true，缓冲区已满时返回false，请求被丢弃
      */
-    virtual std::type_index GetType() const override
+    bool Post(Args... args)
     {
-        return typeid(Delegate<TRet(Args...)>);
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_size == _capacity) {
+            return false;
+        }
+        _Entry &entry = _entries[(_head + _size) % _capacity];
+        new (entry.args) _Args(static_cast<Args &&>(args)...);
+        entry.coalesced = false;
+        ++_size;
+        return true;
     }
 
     /**
-     * @brief       判断当前委托是否与另一个可调用对象相等
-     * @param other 另一个可调用对象
-     * @return      如果相等则返回true，否则返回false
+     * @brief      提交一个可合并的调用请求，若相同键的请求尚未被处理，则只替换其参数，保留其原有的位置
+     * @param key  请求的键
+     * @param args 函数参数，非常量左值引用参数保存引用，其余参数保存副本
+     * @return     成功提交或合并返回true，缓冲区已满时返回false，请求被丢弃
+     * @note       合并时在原位置重新构造参数，因此要求保存的参数类型的移动构造函数不抛出异常
      */
-    virtual bool Equals(const ICallable<TRet(Args...)> &other) const override
+    bool PostCoalesced(size_t key, Args... args)
     {
-        if (this == &other) {
+        static_assert(std::is_nothrow_move_constructible<_Args>::value,
+                      "PostCoalesced requires nothrow move constructible arguments");
+
+        _Args value(static_cast<Args &&>(args)...);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t i = _FindKey(key);
+        if (i != SIZE_MAX) {
+            _Args &stored = _Get(_entries[_keys[i].pos]);
+            stored.~_Args();
+            new (&stored) _Args(std::move(value));
             return true;
         }
-        if (GetType() != other.GetType()) {
+        if (_size == _capacity) {
             return false;
         }
-        const auto &otherDelegate = static_cast<const Delegate &>(other);
-        if (_data.Count() != otherDelegate._data.Count()) {
-            return false;
+        size_t pos    = (_head + _size) % _capacity;
+        _Entry &entry = _entries[pos];
+        new (entry.args) _Args(std::move(value));
+        entry.key       = key;
+        entry.coalesced = true;
+        _InsertKey(key, pos);
+        ++_size;
+        return true;
+    }
+
+    /**
+     * @brief          按提交顺序处理待处理的请求，每个请求调用一次目标委托
+     * @param maxCount 最多处理的请求数量，默认处理调用Flush时已提交的所有请求
+     * @return         实际处理的请求数量
+     * @note           目标委托抛出异常时，该请求被丢弃，异常传递给调用者，剩余的请求保留到下一次Flush
+     */
+    size_t Flush(size_t maxCount = SIZE_MAX)
+    {
+        size_t count;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            count = _size < maxCount ? _size : maxCount;
         }
-        for (size_t i = _data.Count(); i > 0; --i) {
-            if (!_data[i - 1]->Equals(*otherDelegate._data[i - 1])) {
-                return false;
+        for (size_t i = 0; i < count; ++i) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (_size == 0) {
+                return i;
+            }
+            _Entry &entry = _entries[_head];
+            _Args &stored = _Get(entry);
+            _Args value(std::move(stored));
+            stored.~_Args();
+            if (entry.coalesced) _EraseKey(entry.key, _head);
+            _head = (_head + 1) % _capacity;
+            --_size;
+            lock.unlock();
+
+            if (!_target->_data.IsEmpty()) {
+                _Dispatch(value, typename _MakeIndexSequence<sizeof...(Args)>::type());
             }
         }
-        return true;
+        return count;
     }
 
     /**
-     * @brief      调用所有存储的可调用对象，并返回它们的结果
-     * @param args 函数参数
-     * @return     返回一个包含所有可调用对象返回值的vector
+     * @brief 丢弃所有未处理的请求
      */
-    template <typename U = TRet>
-    typename std::enable_if<!std::is_void<U>::value, std::vector<U>>::type
-    InvokeAll(Args... args) const
+    void Clear()
     {
-        std::vector<U> results;
-        size_t count = _data.Count();
-        if (count == 0) {
-            _ThrowEmptyDelegateError();
-        } else if (count == 1) {
-            results.emplace_back(_data[0]->Invoke(std::forward<Args>(args)...));
-        } else {
-#if defined(DELEGATE_DISABLE_SAFEINVOKE)
-            auto &list = _data;
-#else
-            auto list = _data;
-#endif
-            results.reserve(count = list.Count());
-            for (size_t i = 0; i < count; ++i) {
-                results.emplace_back(list[i]->Invoke(std::forward<Args>(args)...));
-            }
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (; _size != 0; --_size) {
+            _Entry &entry = _entries[_head];
+            _Get(entry).~_Args();
+            if (entry.coalesced) _EraseKey(entry.key, _head);
+            _head = (_head + 1) % _capacity;
         }
-        return results;
+        _head = 0;
     }
 
 private:
     /**
-     * @brief 内部函数，用于从后向前查找并移除一个可调用对象
+     * @brief 获取请求中保存的参数
      */
-    bool _Remove(const _ICallable &callable)
+    static _Args &_Get(_Entry &entry) noexcept
     {
-        for (size_t i = _data.Count(); i > 0; --i) {
-            if (_data[i - 1]->Equals(callable)) {
-                return _data.RemoveAt(i - 1);
-            }
-        }
-        return false;
+        return *reinterpret_cast<_Args *>(entry.args);
     }
 
     /**
-     * @brief 内部函数，调用空委托时抛出异常
+     * @brief 使用保存的参数调用目标委托，参数将被移动
      */
-    [[noreturn]] void _ThrowEmptyDelegateError() const
+    template <size_t... Indices>
+    void _Dispatch(_Args &value, _IndexSequence<Indices...>)
     {
-        throw std::runtime_error("Delegate is empty");
+        _target->_InvokeImpl(true, std::get<Indices>(value)...);
     }
 
     /**
-     * @brief 内部函数，Invoke和operator()的实现
+     * @brief 计算键在键表中的初始位置
      */
-    inline TRet _InvokeImpl(Args... args) const
+    size_t _KeyHome(size_t key) const noexcept
     {
-        size_t count = _data.Count();
-        if (count == 0) {
-            _ThrowEmptyDelegateError();
-        } else if (count == 1) {
-            return _data[0]->Invoke(std::forward<Args>(args)...);
-        } else {
-#if defined(DELEGATE_DISABLE_SAFEINVOKE)
-            auto &list = _data;
-#else
-            auto list = _data;
-#endif
-            for (size_t i = 0; i < count - 1; ++i)
-                list[i]->Invoke(std::forward<Args>(args)...);
-            return list[count - 1]->Invoke(std::forward<Args>(args)...);
-        }
+        key *= static_cast<size_t>(0x9E3779B97F4A7C15ull);
+        return (key ^ (key >> (sizeof(size_t) * 4))) & _keyMask;
     }
-};
 
-/*================================================================================*/
+    /**
+     * @brief 查找键在键表中的位置，未找到时返回SIZE_MAX
+     */
+    size_t _FindKey(size_t key) const noexcept
+    {
+        for (size_t i = _KeyHome(key); _keys[i].pos != SIZE_MAX; i = (i + 1) & _keyMask) {
+            if (_keys[i].key == key) return i;
+        }
+        return SIZE_MAX;
+    }
 
-/**
- * @brief 比较委托和nullptr
- * @note  如果委托为空则返回true，否则返回false
- */
-template <typename TRet, typename... Args>
-inline bool operator==(std::nullptr_t, const Delegate<TRet(Args...)> &d) noexcept
-{
-    return d == nullptr;
-}
+    /**
+     * @brief 向键表中插入一个条目
+     */
+    void _InsertKey(size_t key, size_t pos) noexcept
+    {
+        size_t i = _KeyHome(key);
+        while (_keys[i].pos != SIZE_MAX) {
+            i = (i + 1) & _keyMask;
+        }
+        _keys[i].key = key;
+        _keys[i].pos = pos;
+    }
 
-/**
- * @brief 比较委托和nullptr
- * @note  如果委托不为空则返回true，否则返回false
- */
-template <typename TRet, typename... Args>
-inline bool operator!=(std::nullptr_t, const Delegate<TRet(Args...)> &d) noexcept
-{
-    return d != nullptr;
-}
+    /**
+     * @brief 从键表中删除一个条目，并将后续条目前移以填补空位
+     */
+    void _EraseKey(size_t key, size_t pos) noexcept
+    {
+        size_t i = _KeyHome(key);
+        while (_keys[i].pos != pos) {
+            i = (i + 1) & _keyMask;
+        }
+        for (size_t j = (i + 1) & _keyMask; _keys[j].pos != SIZE_MAX; j = (j + 1) & _keyMask) {
+            size_t home = _KeyHome(_keys[j].key);
+            if (((j - home) & _keyMask) >= ((j - i) & _keyMask)) {
+                _keys[i] = _keys[j];
+                i        = j;
+            }
+        }
+        _keys[i].pos = SIZE_MAX;
+    }
+};
 
 /*================================================================================*/
 
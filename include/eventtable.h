@@ -0,0 +1,395 @@
+#ifndef _EVENTTABLE_H_
+#define _EVENTTABLE_H_
+
+#include "delegate.h"
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/*================================================================================*/
+
+/**
+ * @brief 事件的键，用于在EventTable中标识一个事件，TSignature为事件处理函数的签名，如void(int)
+ * @note  通过对象的地址区分不同的事件，通常声明为类的静态成员，每个事件只应存在一个键对象
+ */
+template <typename TSignature>
+class EventKey
+{
+public:
+    /**
+     * @brief 默认构造函数
+     */
+    constexpr EventKey() noexcept
+    {
+    }
+
+    EventKey(const EventKey &)            = delete;
+    EventKey &operator=(const EventKey &) = delete;
+};
+
+/*================================================================================*/
+
+/**
+ * @brief 稀疏的事件表，类似于WinForms中的EventHandlerList，事件表本身只占用一个指针，
+ *        只有存在订阅者的事件才会分配存储处理函数的委托
+ * @note  适用于声明了大量事件而多数事件没有订阅者的类型。查找事件时线性遍历存在订阅者的事件，
+ *        没有订阅者的事件被触发时只需判断一次空指针。该类不是线程安全的，触发事件期间不应销毁事件表
+ */
+class EventTable
+{
+    /**
+     * @brief 单个事件的节点
+     */
+    struct _Node {
+        const void *key;
+        _Node *next      = nullptr;
+        uint32_t raising = 0; // 正在触发该事件的层数，期间事件变为空时不立即释放节点
+
+        explicit _Node(const void *key) noexcept
+            : key(key)
+        {
+        }
+
+        virtual ~_Node()
+        {
+        }
+
+        virtual _Node *Clone() const          = 0;
+        virtual bool IsEmpty() const noexcept = 0;
+        virtual void Clear() noexcept         = 0;
+    };
+
+    /**
+     * @brief 存储某一签名的事件处理函数的节点
+     */
+    template <typename TSignature>
+    struct _EventNode final : _Node {
+        Delegate<TSignature> delegate;
+
+        explicit _EventNode(const EventKey<TSignature> &key) noexcept
+            : _Node(&key)
+        {
+        }
+
+        _Node *Clone() const override
+        {
+            auto node      = new _EventNode(*static_cast<const EventKey<TSignature> *>(key));
+            node->delegate = delegate;
+            return node;
+        }
+
+        bool IsEmpty() const noexcept override
+        {
+            return delegate == nullptr;
+        }
+
+        void Clear() noexcept override
+        {
+            delegate.Clear();
+        }
+    };
+
+    /**
+     * @brief 存在订阅者的事件链表
+     */
+    _Node *_head = nullptr;
+
+public:
+    /**
+     * @brief 默认构造函数，不分配内存
+     */
+    EventTable() noexcept
+    {
+    }
+
+    /**
+     * @brief 复制构造函数，复制所有存在订阅者的事件
+     */
+    EventTable(const EventTable &other)
+    {
+        _Node **tail = &_head;
+        try {
+            for (_Node *node = other._head; node != nullptr; node = node->next) {
+                if (node->IsEmpty()) continue;
+                *tail = node->Clone();
+                tail  = &(*tail)->next;
+            }
+        } catch (...) {
+            _Free(_head);
+            throw;
+        }
+    }
+
+    /**
+     * @brief 移动构造函数
+     */
+    EventTable(EventTable &&other) noexcept
+        : _head(other._head)
+    {
+        other._head = nullptr;
+    }
+
+    /**
+     * @brief 赋值运算符
+     */
+    EventTable &operator=(EventTable other) noexcept
+    {
+        std::swap(_head, other._head);
+        return *this;
+    }
+
+    /**
+     * @brief 析构函数
+     */
+    ~EventTable()
+    {
+        _Free(_head);
+    }
+
+    /**
+     * @brief  为事件添加一个处理函数，参数与Delegate::Add相同
+     * @return 新对象在事件委托中的索引，若没有添加任何对象则返回SIZE_MAX
+     * @note   事件首次被订阅时分配存储处理函数的委托
+     */
+    template <typename TSignature, typename... TArgs>
+    size_t Add(const EventKey<TSignature> &key, TArgs &&...args)
+    {
+        _EventNode<TSignature> *node = _Find(key);
+        if (node != nullptr) {
+            return node->delegate.Add(std::forward<TArgs>(args)...);
+        }
+        std::unique_ptr<_EventNode<TSignature>> created(new _EventNode<TSignature>(key));
+        size_t index = created->delegate.Add(std::forward<TArgs>(args)...);
+        if (!created->IsEmpty()) {
+            created->next = _head;
+            _head         = created.release();
+        }
+        return index;
+    }
+
+    /**
+     * @brief  移除事件的一个处理函数，参数与Delegate::Remove相同
+     * @return 如果成功移除则返回true，否则返回false
+     * @note   事件不再有订阅者时释放其委托
+     */
+    template <typename TSignature, typename... TArgs>
+    bool Remove(const EventKey<TSignature> &key, TArgs &&...args)
+    {
+        _EventNode<TSignature> *node = _Find(key);
+        if (node == nullptr) {
+            return false;
+        }
+        bool removed = node->delegate.Remove(std::forward<TArgs>(args)...);
+        _Trim(node);
+        return removed;
+    }
+
+    /**
+     * @brief  为事件添加一个处理函数，并返回用于移除该对象的令牌，参数与Delegate::Subscribe相同
+     * @return 对应的订阅令牌，若没有添加任何对象则返回空令牌
+     */
+    template <typename TSignature, typename... TArgs>
+    SubscriptionToken Subscribe(const EventKey<TSignature> &key, TArgs &&...args)
+    {
+        _EventNode<TSignature> *node = _Find(key);
+        if (node != nullptr) {
+            return node->delegate.Subscribe(std::forward<TArgs>(args)...);
+        }
+        std::unique_ptr<_EventNode<TSignature>> created(new _EventNode<TSignature>(key));
+        SubscriptionToken token = created->delegate.Subscribe(std::forward<TArgs>(args)...);
+        if (!created->IsEmpty()) {
+            created->next = _head;
+            _head         = created.release();
+        }
+        return token;
+    }
+
+    /**
+     * @brief  移除令牌对应的处理函数
+     * @return 如果令牌有效且成功移除则返回true，否则返回false
+     */
+    template <typename TSignature>
+    bool Unsubscribe(const EventKey<TSignature> &key, SubscriptionToken token)
+    {
+        _EventNode<TSignature> *node = _Find(key);
+        if (node == nullptr) {
+            return false;
+        }
+        bool removed = node->delegate.Unsubscribe(token);
+        _Trim(node);
+        return removed;
+    }
+
+    /**
+     * @brief  触发事件，依次调用事件的所有处理函数
+     * @return 如果事件存在订阅者则返回true，否则返回false
+     * @note   处理函数可以在调用期间订阅或取消订阅事件
+     */
+    template <typename TSignature, typename... TArgs>
+    bool Raise(const EventKey<TSignature> &key, TArgs &&...args)
+    {
+        _EventNode<TSignature> *node = _Find(key);
+        if (node == nullptr || node->IsEmpty()) {
+            return false;
+        }
+        _RaiseGuard guard(*this, node);
+        node->delegate(std::forward<TArgs>(args)...);
+        return true;
+    }
+
+    /**
+     * @brief  获取事件的委托
+     * @return 若事件存在订阅者则返回其委托，否则返回nullptr
+     */
+    template <typename TSignature>
+    const Delegate<TSignature> *Find(const EventKey<TSignature> &key) const noexcept
+    {
+        _EventNode<TSignature> *node = _Find(key);
+        return node == nullptr || node->IsEmpty() ? nullptr : &node->delegate;
+    }
+
+    /**
+     * @brief 获取事件的委托，事件尚不存在时为其分配一个空的委托，可用于调用Delegate的其他添加函数
+     * @note  委托保持为空时会在下次移除处理函数或调用Trim时被释放
+     */
+    template <typename TSignature>
+    Delegate<TSignature> &Get(const EventKey<TSignature> &key)
+    {
+        _EventNode<TSignature> *node = _Find(key);
+        if (node == nullptr) {
+            node       = new _EventNode<TSignature>(key);
+            node->next = _head;
+            _head      = node;
+        }
+        return node->delegate;
+    }
+
+    /**
+     * @brief 判断事件是否存在订阅者
+     */
+    template <typename TSignature>
+    bool Contains(const EventKey<TSignature> &key) const noexcept
+    {
+        return Find(key) != nullptr;
+    }
+
+    /**
+     * @brief 判断是否没有任何事件存在订阅者
+     */
+    bool IsEmpty() const noexcept
+    {
+        for (_Node *node = _head; node != nullptr; node = node->next) {
+            if (!node->IsEmpty()) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 移除事件的所有处理函数并释放其委托
+     */
+    template <typename TSignature>
+    void Clear(const EventKey<TSignature> &key) noexcept
+    {
+        _EventNode<TSignature> *node = _Find(key);
+        if (node != nullptr) {
+            node->Clear();
+            _Trim(node);
+        }
+    }
+
+    /**
+     * @brief 移除所有事件的处理函数并释放其委托
+     */
+    void Clear() noexcept
+    {
+        for (_Node *node = _head; node != nullptr; node = node->next) {
+            node->Clear();
+        }
+        Trim();
+    }
+
+    /**
+     * @brief 释放所有没有订阅者的事件的委托，正在触发的事件除外
+     */
+    void Trim() noexcept
+    {
+        for (_Node **link = &_head; *link != nullptr;) {
+            _Node *node = *link;
+            if (node->raising == 0 && node->IsEmpty()) {
+                *link = node->next;
+                delete node;
+            } else {
+                link = &node->next;
+            }
+        }
+    }
+
+private:
+    /**
+     * @brief 触发事件期间保持节点不被释放，结束后若事件已没有订阅者则释放节点
+     */
+    class _RaiseGuard
+    {
+        EventTable &_table;
+        _Node *_node;
+
+    public:
+        _RaiseGuard(EventTable &table, _Node *node) noexcept
+            : _table(table), _node(node)
+        {
+            ++_node->raising;
+        }
+
+        ~_RaiseGuard()
+        {
+            --_node->raising;
+            _table._Trim(_node);
+        }
+
+        _RaiseGuard(const _RaiseGuard &)            = delete;
+        _RaiseGuard &operator=(const _RaiseGuard &) = delete;
+    };
+
+    /**
+     * @brief 内部函数，查找事件对应的节点
+     */
+    template <typename TSignature>
+    _EventNode<TSignature> *_Find(const EventKey<TSignature> &key) const noexcept
+    {
+        for (_Node *node = _head; node != nullptr; node = node->next) {
+            if (node->key == &key) return static_cast<_EventNode<TSignature> *>(node);
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief 内部函数，若节点没有订阅者且未在触发中则将其释放
+     */
+    void _Trim(_Node *node) noexcept
+    {
+        if (node->raising != 0 || !node->IsEmpty()) {
+            return;
+        }
+        for (_Node **link = &_head; *link != nullptr; link = &(*link)->next) {
+            if (*link == node) {
+                *link = node->next;
+                delete node;
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief 内部函数，释放链表中的所有节点
+     */
+    static void _Free(_Node *node) noexcept
+    {
+        while (node != nullptr) {
+            _Node *next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+};
+
+#endif // _EVENTTABLE_H_
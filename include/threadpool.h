@@ -0,0 +1,246 @@
+#ifndef _THREADPOOL_H_
+#define _THREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*================================================================================*/
+
+/**
+ * @brief 工作窃取线程池，每个工作线程拥有自己的任务队列，队列为空时从其他线程的队列中窃取任务
+ * @note  可作为Delegate::InvokeAllParallel等函数的执行器使用。任务不应抛出异常，否则将调用std::terminate；
+ *        析构时会等待所有已提交的任务执行完毕
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @brief 任务类型
+     */
+    using TTask = std::function<void()>;
+
+private:
+    /**
+     * @brief 工作线程的任务队列，所有者从队尾取任务，其他线程从队首窃取任务
+     */
+    struct _Queue {
+        std::mutex mutex;
+        std::deque<TTask> tasks;
+    };
+
+    /**
+     * @brief 当前线程所属的线程池及其队列序号
+     */
+    struct _Current {
+        const ThreadPool *pool = nullptr;
+        size_t index           = 0;
+    };
+
+    /**
+     * @brief 各工作线程的任务队列
+     */
+    std::vector<std::unique_ptr<_Queue>> _queues;
+
+    /**
+     * @brief 工作线程
+     */
+    std::vector<std::thread> _threads;
+
+    /**
+     * @brief 保护_stop的互斥量，空闲线程持有该互斥量进入休眠；提交和取出任务时不使用
+     */
+    std::mutex _mutex;
+
+    /**
+     * @brief 通知空闲线程有新任务或线程池停止
+     */
+    std::condition_variable _cv;
+
+    /**
+     * @brief 已提交但尚未被取出的任务数量
+     * @note  任务先入队再计数，取出任务的线程可能先于计数完成递减，因此该值可能短暂为负
+     */
+    std::atomic<std::ptrdiff_t> _pending;
+
+    /**
+     * @brief 正在或即将进入休眠的工作线程数量，为0时提交任务无需唤醒
+     */
+    std::atomic<size_t> _sleeping;
+
+    /**
+     * @brief 是否已停止
+     */
+    bool _stop = false;
+
+    /**
+     * @brief 外部线程提交任务时轮流选择队列
+     */
+    std::atomic<size_t> _nextQueue;
+
+public:
+    /**
+     * @brief             构造函数
+     * @param threadCount 工作线程数量，为0时使用硬件并发数
+     */
+    explicit ThreadPool(size_t threadCount = 0)
+        : _pending(0), _sleeping(0), _nextQueue(0)
+    {
+        if (threadCount == 0) {
+            threadCount = std::thread::hardware_concurrency();
+            if (threadCount == 0) threadCount = 1;
+        }
+        for (size_t i = 0; i < threadCount; ++i) {
+            _queues.emplace_back(new _Queue);
+        }
+        try {
+            for (size_t i = 0; i < threadCount; ++i) {
+                _threads.emplace_back(&ThreadPool::_WorkerMain, this, i);
+            }
+        } catch (...) {
+            _Shutdown();
+            throw;
+        }
+    }
+
+    /**
+     * @brief 析构函数，等待所有已提交的任务执行完毕后结束工作线程
+     */
+    ~ThreadPool()
+    {
+        _Shutdown();
+    }
+
+    ThreadPool(const ThreadPool &)            = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @brief 获取工作线程的数量
+     */
+    size_t Size() const noexcept
+    {
+        return _queues.size();
+    }
+
+    /**
+     * @brief      提交一个任务
+     * @param task 可调用对象，形如void()
+     * @note       在工作线程中提交的任务放入该线程自己的队列，否则轮流放入各个队列
+     */
+    template <typename F>
+    void Post(F &&task)
+    {
+        TTask item(std::forward<F>(task));
+
+        _Current &current = _GetCurrent();
+        size_t index      = current.pool == this
+                                ? current.index
+                                : _nextQueue.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+        {
+            std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+            _queues[index]->tasks.push_back(std::move(item));
+        }
+        // 先计数再检查休眠线程，与_WorkerMain中先登记休眠再检查计数相对应，二者至少有一方能看到对方的修改
+        _pending.fetch_add(1, std::memory_order_seq_cst);
+        if (_sleeping.load(std::memory_order_seq_cst) != 0) {
+            // 获取互斥量保证正在登记休眠的线程已进入等待或将看到新的计数
+            { std::lock_guard<std::mutex> lock(_mutex); }
+            _cv.notify_one();
+        }
+    }
+
+    /**
+     * @brief 获取默认的全局线程池，工作线程数量为硬件并发数
+     */
+    static ThreadPool &Default()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+private:
+    /**
+     * @brief 获取当前线程的信息
+     */
+    static _Current &_GetCurrent() noexcept
+    {
+        static thread_local _Current current;
+        return current;
+    }
+
+    /**
+     * @brief 从自己的队尾取出任务，失败时依次从其他队列的队首窃取任务
+     */
+    bool _TryPop(size_t index, TTask &task)
+    {
+        {
+            _Queue &own = *_queues[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < _queues.size(); ++i) {
+            _Queue &victim = *_queues[(index + i) % _queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 工作线程的主函数
+     */
+    void _WorkerMain(size_t index)
+    {
+        _Current &current = _GetCurrent();
+        current.pool      = this;
+        current.index     = index;
+
+        TTask task;
+        for (;;) {
+            if (_TryPop(index, task)) {
+                _pending.fetch_sub(1, std::memory_order_relaxed);
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(_mutex);
+            _sleeping.fetch_add(1, std::memory_order_seq_cst);
+            _cv.wait(lock, [this] { return _stop || _pending.load(std::memory_order_seq_cst) > 0; });
+            _sleeping.fetch_sub(1, std::memory_order_relaxed);
+            if (_stop && _pending.load(std::memory_order_seq_cst) <= 0) break;
+        }
+    }
+
+    /**
+     * @brief 停止线程池并等待工作线程结束
+     */
+    void _Shutdown() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _cv.notify_all();
+        for (auto &thread : _threads) {
+            if (thread.joinable()) thread.join();
+        }
+        _threads.clear();
+    }
+};
+
+#endif // _THREADPOOL_H_
@@ -0,0 +1,128 @@
+/**
+ * ConcurrentDelegate的并发测试：多个线程调用委托的同时，其他线程反复添加、移除和订阅可调用对象。
+ */
+
+#include "delegate.h"
+#include "test.h"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    std::atomic<long> g_live(0);   // 存活的Handler对象数量
+    std::atomic<long> g_calls(0);  // 固定对象被调用的次数
+    std::atomic<long> g_broken(0); // 观察到不一致快照的次数
+
+    void Fixed(int) { ++g_calls; }
+    void Toggled(int) {}
+
+    /**
+     * @brief 记录存活数量的可调用对象，足够大以存储在堆上
+     */
+    struct Handler {
+        std::string pad;
+
+        Handler() : pad(64, 'h') { ++g_live; }
+        Handler(const Handler &other) : pad(other.pad) { ++g_live; }
+        ~Handler() { --g_live; }
+        void operator()(int) const
+        {
+            if (pad.size() != 64) ++g_broken; // 调用已释放的对象时通常无法通过该检查
+        }
+    };
+}
+
+TEST_CASE(InvokeWhileWritersMutate)
+{
+    const int readers    = 4;
+    const int iterations = 20000;
+
+    long invocations = 0;
+    {
+        ConcurrentDelegate<void(int)> d;
+        d += Fixed;
+        for (int i = 0; i < 8; ++i) d += Handler();
+
+        std::atomic<bool> stop(false);
+        std::atomic<long> total(0);
+        std::vector<std::thread> threads;
+        for (int r = 0; r < readers; ++r) {
+            threads.emplace_back([&] {
+                long count = 0;
+                while (!stop.load()) {
+                    d(0);
+                    ++count;
+                }
+                total += count;
+            });
+        }
+
+        // 两个写者：一个反复添加和移除同一函数，另一个通过令牌订阅和退订
+        std::thread toggler([&] {
+            for (int i = 0; i < iterations; ++i) {
+                d += Toggled;
+                d -= Toggled;
+            }
+        });
+        std::thread subscriber([&] {
+            for (int i = 0; i < iterations; ++i) {
+                SubscriptionToken token = d.Subscribe(Handler());
+                TEST_CHECK(d.Unsubscribe(token));
+            }
+        });
+        toggler.join();
+        subscriber.join();
+        stop = true;
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        invocations = total.load();
+
+        // 所有调用结束后回收旧快照，只剩当前快照中的对象
+        d.Reclaim();
+        TEST_CHECK(g_live == 8);
+        TEST_CHECK(d.GetSnapshot() != nullptr);
+    }
+
+    TEST_CHECK(g_live == 0);
+    TEST_CHECK(g_broken == 0);
+    TEST_CHECK(g_calls == invocations); // 每次调用看到的快照都恰好包含一次固定对象
+}
+
+TEST_CASE(SnapshotsAreConsistent)
+{
+    // 写者成对地添加和移除对象，调用看到的对象数量总是偶数
+    ConcurrentDelegate<void(std::atomic<int> &)> d;
+    auto inc = [](std::atomic<int> &n) { ++n; };
+    std::atomic<bool> stop(false);
+    std::atomic<long> odd(0);
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < 3; ++r) {
+        threads.emplace_back([&] {
+            while (!stop.load()) {
+                std::atomic<int> n(0);
+                try {
+                    d(n);
+                } catch (const std::runtime_error &) {
+                    // 委托为空
+                }
+                if (n % 2 != 0) ++odd;
+            }
+        });
+    }
+    for (int i = 0; i < 5000; ++i) {
+        d.AddRange({+inc, +inc});
+        if (i % 3 == 0) d.Clear();
+    }
+    stop = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    TEST_CHECK(odd == 0);
+}
+
+TEST_MAIN()
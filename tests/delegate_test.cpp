@@ -0,0 +1,526 @@
+/**
+ * Delegate的功能测试：复制语义、调用过程中的重入修改、订阅令牌、合并与移除序列、抛出异常的可调用对象。
+ */
+
+#include "delegate.h"
+#include "test.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    std::string g_trace;
+
+    void A(int) { g_trace += 'a'; }
+    void B(int) { g_trace += 'b'; }
+    void C(int) { g_trace += 'c'; }
+
+    /**
+     * @brief 复制时可以抛出异常的可调用对象，Size控制对象是否能存储在委托内部
+     */
+    template <size_t Size>
+    struct ThrowingCopy {
+        static bool throwOnCopy;
+        char pad[Size];
+
+        ThrowingCopy() : pad() {}
+        ThrowingCopy(const ThrowingCopy &other)
+        {
+            if (throwOnCopy) throw std::runtime_error("copy failed");
+            std::copy(other.pad, other.pad + Size, pad);
+        }
+        void operator()(int) const { g_trace += 't'; }
+    };
+
+    template <size_t Size>
+    bool ThrowingCopy<Size>::throwOnCopy = false;
+
+    /**
+     * @brief 依次在空委托、预留了空间的空委托、只有一个对象的委托和多个对象的委托上添加抛出异常的对象
+     */
+    template <typename T>
+    void CheckThrowingAdd()
+    {
+        T thrower;
+        T::throwOnCopy = true;
+
+        Action<int> empty;
+        TEST_CHECK_THROWS(empty += thrower, std::runtime_error);
+        TEST_CHECK(empty == nullptr);
+
+        Action<int> reserved;
+        reserved.Reserve(8);
+        TEST_CHECK_THROWS(reserved += thrower, std::runtime_error);
+        TEST_CHECK(reserved == nullptr);
+        TEST_CHECK_THROWS(reserved(0), std::runtime_error); // 空委托调用时抛出异常而不是访问空槽
+        reserved += A;
+        g_trace.clear();
+        reserved(0);
+        TEST_CHECK(g_trace == "a");
+
+        Action<int> single = A;
+        TEST_CHECK_THROWS(single += thrower, std::runtime_error);
+        g_trace.clear();
+        single(0);
+        TEST_CHECK(g_trace == "a");
+
+        Action<int> list = A;
+        list += B;
+        TEST_CHECK_THROWS(list.Add(thrower, 1), std::runtime_error);
+        g_trace.clear();
+        list(0);
+        TEST_CHECK(g_trace == "ab");
+
+        T::throwOnCopy = false;
+    }
+}
+
+/*================================================================================*/
+// 复制语义：复制的委托总是共享可调用对象，DeepClone得到独立的副本
+
+namespace
+{
+    /**
+     * @brief 调用次数计数器，只有非const调用运算符，Size控制对象是否能存储在委托内部
+     */
+    template <size_t Size>
+    struct Counter {
+        int n;
+        char pad[Size];
+
+        explicit Counter(int n = 0) : n(n), pad() {}
+        int operator()() { return ++n; }
+    };
+}
+
+TEST_CASE(CopySharesMutableStateRegardlessOfSize)
+{
+    // 小对象与大对象的行为一致
+    Func<int> small = Counter<1>();
+    Func<int> smallCopy = small;
+    small();
+    small();
+    TEST_CHECK(smallCopy() == 3);
+
+    Func<int> large = Counter<64>();
+    Func<int> largeCopy;
+    largeCopy = large;
+    large();
+    large();
+    TEST_CHECK(largeCopy() == 3);
+}
+
+TEST_CASE(CopySharesMutableStateAfterMutation)
+{
+    // 修改其中一个委托会复制内存块，但对象的状态仍然共享
+    Func<int> a;
+    a += Counter<1>(0);
+    a += Counter<1>(100);
+    Func<int> b = a;
+    a += [] { return -1; };
+    a();
+    a();
+    TEST_CHECK(b.InvokeAll() == (std::vector<int>{3, 103}));
+
+    b.Add(Counter<1>(1000), 1); // 按优先级插入，移动已有的对象
+    TEST_CHECK(a.InvokeAll() == (std::vector<int>{4, 104, -1}));
+    TEST_CHECK(b.InvokeAll() == (std::vector<int>{1001, 5, 105}));
+}
+
+TEST_CASE(DeepCloneCopiesMutableState)
+{
+    Func<int> a;
+    a += Counter<1>(0);
+    a += Counter<64>(10);
+    a();
+    Func<int> b = a.DeepClone();
+    a();
+    TEST_CHECK(b.InvokeAll() == (std::vector<int>{2, 12}));
+    TEST_CHECK(a.InvokeAll() == (std::vector<int>{3, 13}));
+}
+
+/*================================================================================*/
+// 调用过程中的重入修改
+
+TEST_CASE(ReentrantClearAndAddDuringDispatch)
+{
+    // 调用过程中的修改不影响本次调用，下一次调用时生效
+    Action<int> e;
+    Action<int> *pe = &e;
+    std::vector<int> order;
+    std::string pad(64, 'x'); // 使可调用对象存储在堆上
+    e += [&order, pe, pad](int) { order.push_back(1); pe->Clear(); };
+    e += [&order, pe, pad](int) { order.push_back(2); *pe += A; };
+    e += [&order, pad](int) { order.push_back(3); };
+    e(0);
+    TEST_CHECK((order == std::vector<int>{1, 2, 3}));
+
+    g_trace.clear();
+    e(0);
+    TEST_CHECK(g_trace == "a");
+}
+
+TEST_CASE(ReentrantRecursiveDispatch)
+{
+    Action<int> e;
+    Action<int> *pe = &e;
+    int calls       = 0;
+    e += [pe, &calls](int n) {
+        ++calls;
+        *pe += B;
+        if (n > 0) (*pe)(n - 1);
+        *pe -= B;
+    };
+    e += A;
+    g_trace.clear();
+    e(3);
+    TEST_CHECK(calls == 4);
+    // 每一层调用看到的是进入时的列表，内层调用时外层添加的B仍然存在
+    TEST_CHECK(g_trace == "abbbabbaba");
+
+    g_trace.clear();
+    e(0);
+    TEST_CHECK(g_trace == "a");
+}
+
+TEST_CASE(ReentrantMoveDuringDispatch)
+{
+    // 调用过程中委托被移动走，本次调用仍然完整执行
+    Action<int> e;
+    Action<int> sink;
+    Action<int> *pe = &e, *psink = &sink;
+    std::string pad(64, 'x');
+    e += [pe, psink, pad](int) { *psink = std::move(*pe); };
+    e += [pad](int) { g_trace += 'z'; };
+    g_trace.clear();
+    e(0);
+    TEST_CHECK(g_trace == "z");
+    TEST_CHECK(e == nullptr);
+    g_trace.clear();
+    sink(0);
+    TEST_CHECK(g_trace == "z");
+}
+
+TEST_CASE(ReentrantUnsubscribeSelf)
+{
+    Action<> d;
+    SubscriptionToken token;
+    token = d.Subscribe([&] { g_trace += 'd'; d.Unsubscribe(token); });
+    d.Subscribe([] { g_trace += 'e'; });
+    g_trace.clear();
+    d();
+    d();
+    TEST_CHECK(g_trace == "dee");
+}
+
+/*================================================================================*/
+// 订阅令牌
+
+TEST_CASE(TokenUnsubscribe)
+{
+    Action<> a;
+    std::vector<SubscriptionToken> tokens;
+    for (int i = 0; i < 10; ++i) {
+        tokens.push_back(a.Subscribe([i] { g_trace += char('0' + i); }));
+    }
+    TEST_CHECK(a.Unsubscribe(tokens[3]));
+    TEST_CHECK(!a.Unsubscribe(tokens[3]));
+    TEST_CHECK(a.Unsubscribe(tokens[9]));
+    g_trace.clear();
+    a();
+    TEST_CHECK(g_trace == "01245678");
+    TEST_CHECK(!a.Unsubscribe(SubscriptionToken()));
+    TEST_CHECK(!a.Unsubscribe(SubscriptionToken(0x12345678ull)));
+}
+
+TEST_CASE(TokenAfterChurn)
+{
+    // 移除对象留下空槽后，新对象的索引和令牌仍然指向正确的对象
+    Action<> a;
+    std::vector<SubscriptionToken> tokens;
+    for (int i = 0; i < 8; ++i) {
+        tokens.push_back(a.Subscribe([i] { g_trace += char('0' + i); }));
+    }
+    for (int i = 1; i < 8; i += 2) {
+        TEST_CHECK(a.Unsubscribe(tokens[i]));
+    }
+    TEST_CHECK(a.Add([] { g_trace += 'x'; }) == 4);
+    auto tail = a.Subscribe([] { g_trace += 'y'; });
+    auto head = a.Subscribe([] { g_trace += 'z'; }, 1);
+    TEST_CHECK(a.Add([] { g_trace += 'w'; }, 1) == 1);
+    g_trace.clear();
+    a();
+    TEST_CHECK(g_trace == "zw0246xy");
+
+    TEST_CHECK(a.Unsubscribe(tail));
+    TEST_CHECK(a.Unsubscribe(head));
+    TEST_CHECK(a.Unsubscribe(tokens[4]));
+    g_trace.clear();
+    a();
+    TEST_CHECK(g_trace == "w026x");
+}
+
+TEST_CASE(TokenValidInCopiesMadeBeforeIssue)
+{
+    Action<> a;
+    auto t0 = a.Subscribe([] { g_trace += '0'; });
+    a.Subscribe([] { g_trace += '1'; });
+    Action<> b = a;
+    TEST_CHECK(b.Unsubscribe(t0));
+    g_trace.clear();
+    a();
+    TEST_CHECK(g_trace == "01");
+    g_trace.clear();
+    b();
+    TEST_CHECK(g_trace == "1");
+    TEST_CHECK(a.Unsubscribe(t0));
+}
+
+TEST_CASE(TokenRejectedByDivergedCopy)
+{
+    Action<int> d;
+    d += A;
+    Action<int> e = d;
+    auto te       = e.Subscribe(B);
+    d.Subscribe(C);
+    TEST_CHECK(!d.Unsubscribe(te));
+    g_trace.clear();
+    d(0);
+    TEST_CHECK(g_trace == "ac");
+    TEST_CHECK(e.Unsubscribe(te));
+    g_trace.clear();
+    e(0);
+    TEST_CHECK(g_trace == "a");
+
+    Action<int> other;
+    auto to = other.Subscribe(A);
+    Action<int> unrelated;
+    unrelated.Subscribe(A);
+    TEST_CHECK(!unrelated.Unsubscribe(to));
+}
+
+TEST_CASE(ScopedSubscriptionRemovesOnDestruction)
+{
+    Action<> c;
+    c += [] { g_trace += 'x'; };
+    {
+        ScopedSubscription s(c, c.Subscribe([] { g_trace += 'y'; }));
+        g_trace.clear();
+        c();
+        TEST_CHECK(g_trace == "xy");
+    }
+    g_trace.clear();
+    c();
+    TEST_CHECK(g_trace == "x");
+}
+
+/*================================================================================*/
+// 合并与移除序列
+
+TEST_CASE(CombineFlattens)
+{
+    Delegate<void(int)> a = A, b = B, c = C;
+    Delegate<void(int)> abc = a + b + c;
+    Delegate<void(int)> hand;
+    hand += A;
+    hand += B;
+    hand += C;
+    TEST_CHECK(abc == hand);
+
+    g_trace.clear();
+    (abc + abc)(0);
+    TEST_CHECK(g_trace == "abcabc");
+}
+
+TEST_CASE(CombineEmptyAndSettings)
+{
+    Delegate<void(int)> a = A, e;
+    TEST_CHECK(e + a == a);
+    TEST_CHECK(a + e == a);
+    TEST_CHECK((e + e) == nullptr);
+
+    // 结果总是使用左操作数的设置
+    Action<int> indexed;
+    indexed.SetIndexed(true);
+    Action<int> plain = B;
+    TEST_CHECK(Action<int>::Combine(indexed, plain).IsIndexed());
+    TEST_CHECK(!Action<int>::Combine(plain, indexed).IsIndexed());
+}
+
+TEST_CASE(CombineKeepsPriorities)
+{
+    Delegate<void(int)> a = A, p;
+    p.Add(C, 5);
+    g_trace.clear();
+    (a + p)(0);
+    TEST_CHECK(g_trace == "ca");
+}
+
+TEST_CASE(RemoveSequence)
+{
+    Delegate<void(int)> a = A, b = B, c = C;
+    Delegate<void(int)> x = a + b + c + a + b + c;
+
+    g_trace.clear();
+    (x - a)(0); // 移除最后一个a
+    TEST_CHECK(g_trace == "abcbc");
+
+    g_trace.clear();
+    (x - (b + c))(0); // 移除最后一段连续的b、c
+    TEST_CHECK(g_trace == "abca");
+
+    TEST_CHECK(Delegate<void(int)>::Remove(x, c + b) == x); // 找不到时不变
+    TEST_CHECK(Delegate<void(int)>::Remove(x, x) == nullptr);
+    TEST_CHECK(x - Delegate<void(int)>() == x);
+    TEST_CHECK(Delegate<void(int)>() - a == nullptr);
+}
+
+TEST_CASE(RemoveSequenceSkipsRemovedSlots)
+{
+    Delegate<void(int)> h;
+    for (int i = 0; i < 10; ++i) {
+        h += A;
+        h += B;
+    }
+    h.Remove(A);
+    h.Remove(A);
+    Delegate<void(int)> a = A, b = B;
+    g_trace.clear();
+    (h - (a + b))(0);
+    TEST_CHECK(g_trace == "abababababababbb");
+}
+
+/*================================================================================*/
+// 抛出异常的可调用对象
+
+TEST_CASE(ThrowingConstructorLeavesDelegateUnchanged)
+{
+    CheckThrowingAdd<ThrowingCopy<1>>();   // 存储在委托内部
+    CheckThrowingAdd<ThrowingCopy<256>>(); // 存储在堆上
+}
+
+TEST_CASE(ThrowingConstructorInAddRange)
+{
+    std::vector<ThrowingCopy<1>> items(3);
+    ThrowingCopy<1>::throwOnCopy = true;
+
+    // 第一个元素复制失败，预留的空间不会使委托变为非空
+    Action<int> d;
+    TEST_CHECK_THROWS(d.AddRange(items), std::runtime_error);
+    TEST_CHECK(d == nullptr);
+    TEST_CHECK_THROWS(d(0), std::runtime_error);
+
+    // 已经添加的元素保留
+    Action<int> e = A;
+    TEST_CHECK_THROWS(e.AddRange(items), std::runtime_error);
+    g_trace.clear();
+    e(0);
+    TEST_CHECK(g_trace == "a");
+
+    ThrowingCopy<1>::throwOnCopy = false;
+    d.AddRange(items);
+    g_trace.clear();
+    d(0);
+    TEST_CHECK(g_trace == "ttt");
+}
+
+/*================================================================================*/
+// 弱订阅
+
+namespace
+{
+    struct Listener : Trackable {
+        int OnValue(int value) { return value; }
+    };
+
+    /**
+     * @brief 在新线程上同步执行每个任务的执行器，使InvokeAllParallel的调用都发生在其他线程上
+     */
+    struct ThreadExecutor {
+        template <typename F>
+        void Post(F &&task)
+        {
+            std::thread(std::forward<F>(task)).join();
+        }
+    };
+
+    int Identity(int value) { return value; }
+}
+
+TEST_CASE(ExpiredWeakPrunedAfterDispatch)
+{
+    Delegate<int(int)> d = Identity;
+    {
+        Listener listener;
+        d.AddWeak(listener, &Listener::OnValue);
+    }
+    d += Identity;
+    TEST_CHECK(d.InvokeAll(1) == (std::vector<int>{1, 0, 1}));
+    d += Identity; // 添加对象前移除调用期间发现的失效对象
+    TEST_CHECK(d.RemoveExpired() == 0);
+}
+
+TEST_CASE(ExpiredWeakPrunedAfterParallelDispatch)
+{
+    Delegate<int(int)> d = Identity;
+    {
+        Listener listener;
+        d.AddWeak(listener, &Listener::OnValue);
+    }
+    d += Identity;
+    ThreadExecutor executor;
+    TEST_CHECK(d.InvokeAllParallel(executor, 1) == (std::vector<int>{1, 0, 1}));
+    d += Identity;
+    TEST_CHECK(d.RemoveExpired() == 0);
+}
+
+TEST_CASE(ExpiredWeakPrunedInNestedDelegate)
+{
+    Delegate<int(int)> inner = Identity;
+    {
+        Listener listener;
+        inner.AddWeak(listener, &Listener::OnValue);
+    }
+    Delegate<int(int)> outer = Identity;
+    outer += inner;
+    outer += Identity;
+    outer(1);
+
+    // 外层的内存块中没有失效的对象
+    outer += Identity;
+    TEST_CHECK(outer.RemoveExpired() == 0);
+    TEST_CHECK(outer.InvokeAll(1) == (std::vector<int>{1, 0, 1, 1}));
+
+    // 内层副本与inner共享内存块，失效的对象由内层的调用标记
+    inner += Identity;
+    TEST_CHECK(inner.RemoveExpired() == 0);
+}
+
+/*================================================================================*/
+// 固定容量的委托
+
+TEST_CASE(StaticDelegateTryAddReportsOverflow)
+{
+    StaticDelegate<void(int), 2> d;
+    TEST_CHECK(d.TryAdd(A));
+    TEST_CHECK(d.TryAdd([](int) { g_trace += 'b'; }));
+    TEST_CHECK(!d.TryAdd(C));
+    TEST_CHECK(d.Count() == 2);
+    TEST_CHECK_THROWS(d.Add(C), std::length_error);
+
+    g_trace.clear();
+    d(0);
+    TEST_CHECK(g_trace == "ab");
+
+    // 移除后空出的容量可以再次使用
+    TEST_CHECK(d.Remove(A));
+    TEST_CHECK(d.TryAdd(C));
+    g_trace.clear();
+    d(0);
+    TEST_CHECK(g_trace == "bc");
+}
+
+TEST_MAIN()
@@ -0,0 +1,111 @@
+/**
+ * 测试使用的简单框架，不依赖第三方库。
+ * 通过TEST_CASE定义测试用例，TEST_CHECK检查条件，失败时输出位置并使测试程序返回非零值。
+ * 检查不依赖assert，因此在定义了NDEBUG的Release构建中同样有效。
+ */
+
+#ifndef _CPPSHARP_TEST_H_
+#define _CPPSHARP_TEST_H_
+
+#include <cstdio>
+#include <exception>
+#include <vector>
+
+namespace test
+{
+    /**
+     * @brief 测试用例
+     */
+    struct Case {
+        const char *name;
+        void (*func)();
+    };
+
+    /**
+     * @brief 获取所有已注册的测试用例
+     */
+    inline std::vector<Case> &Cases()
+    {
+        static std::vector<Case> cases;
+        return cases;
+    }
+
+    /**
+     * @brief 获取失败的检查数量
+     */
+    inline int &Failures()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+    /**
+     * @brief 注册测试用例，由TEST_CASE使用
+     */
+    struct Registrar {
+        Registrar(const char *name, void (*func)())
+        {
+            Cases().push_back(Case{name, func});
+        }
+    };
+
+    /**
+     * @brief 记录一次失败的检查
+     */
+    inline void Fail(const char *file, int line, const char *expr)
+    {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+        ++Failures();
+    }
+
+    /**
+     * @brief  依次运行所有测试用例
+     * @return 全部通过时返回0，否则返回1
+     */
+    inline int RunAll()
+    {
+        for (const Case &c : Cases()) {
+            int before = Failures();
+            try {
+                c.func();
+            } catch (const std::exception &e) {
+                std::fprintf(stderr, "%s: unexpected exception: %s\n", c.name, e.what());
+                ++Failures();
+            } catch (...) {
+                std::fprintf(stderr, "%s: unexpected exception\n", c.name);
+                ++Failures();
+            }
+            std::printf("[%s] %s\n", Failures() == before ? "PASS" : "FAIL", c.name);
+        }
+        return Failures() == 0 ? 0 : 1;
+    }
+}
+
+#define TEST_CASE(name)                                        \
+    static void name();                                        \
+    static ::test::Registrar name##_registrar(#name, &name);   \
+    static void name()
+
+#define TEST_CHECK(expr)                                       \
+    do {                                                       \
+        if (!(expr)) ::test::Fail(__FILE__, __LINE__, #expr);  \
+    } while (0)
+
+#define TEST_CHECK_THROWS(expr, type)                          \
+    do {                                                       \
+        bool _thrown = false;                                  \
+        try {                                                  \
+            expr;                                              \
+        } catch (const type &) {                               \
+            _thrown = true;                                    \
+        }                                                      \
+        if (!_thrown) ::test::Fail(__FILE__, __LINE__, #expr); \
+    } while (0)
+
+#define TEST_MAIN()            \
+    int main()                 \
+    {                          \
+        return test::RunAll(); \
+    }
+
+#endif // _CPPSHARP_TEST_H_
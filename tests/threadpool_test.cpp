@@ -0,0 +1,55 @@
+/**
+ * ThreadPool的测试：多个线程同时提交任务、任务中继续提交任务，析构时所有任务均已执行。
+ */
+
+#include "threadpool.h"
+#include "test.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+TEST_CASE(AllPostedTasksRun)
+{
+    // 反复创建线程池，覆盖工作线程休眠与唤醒之间的竞争
+    for (int round = 0; round < 50; ++round) {
+        std::atomic<int> count(0);
+        {
+            ThreadPool pool(4);
+            std::vector<std::thread> producers;
+            for (int t = 0; t < 3; ++t) {
+                producers.emplace_back([&] {
+                    for (int i = 0; i < 200; ++i) {
+                        pool.Post([&] {
+                            ++count;
+                            pool.Post([&] { ++count; }); // 放入当前工作线程的队列
+                        });
+                        if (i % 50 == 0) std::this_thread::sleep_for(std::chrono::microseconds(100));
+                    }
+                });
+            }
+            for (auto &producer : producers) {
+                producer.join();
+            }
+        }
+        TEST_CHECK(count == 1200);
+    }
+}
+
+TEST_CASE(IdleWorkersWakeForLateTasks)
+{
+    ThreadPool pool(2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10)); // 等待工作线程进入休眠
+    std::atomic<int> count(0);
+    for (int i = 0; i < 10; ++i) {
+        pool.Post([&] { ++count; });
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (count != 10 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    TEST_CHECK(count == 10);
+}
+
+TEST_MAIN()